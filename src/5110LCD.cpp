@@ -9,12 +9,15 @@
  */
  
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <stdlib.h>
 #include <util/delay.h>
 #include "5110LCD.h"
 #include "fonts.h"
 #include "hardware.h"
 
+extern LCD lcd;
+
 /******************************************************************
  *
  *   LCD::LCD()
@@ -24,6 +27,72 @@
 
 LCD::LCD()
 {
+    for(uint8_t j = 0; j < LCD_BANKS; j++)
+    {
+        dirtyMin[j] = 0xFF;
+        dirtyMax[j] = 0;
+    }
+}
+
+/******************************************************************
+ *
+ *   LCD::touch
+ *   Marks a byte of the frame as changed
+ *
+ ******************************************************************/
+
+void LCD::touch(unsigned char x, unsigned char bank)
+{
+    if(x < dirtyMin[bank]) dirtyMin[bank] = x;
+    if(x > dirtyMax[bank]) dirtyMax[bank] = x;
+}
+
+/******************************************************************
+ *
+ *   LCD::column
+ *   ORs a glyph column (bit 0 at the top) into the one or two bank
+ *   bytes it covers at x, y
+ *
+ ******************************************************************/
+
+void LCD::column(unsigned char x, unsigned char y, unsigned char bits)
+{
+    unsigned char bank, shift, b;
+
+    if(!bits || x > LCD_WIDTH - 1) return;
+
+    if(y > LCD_HEIGHT - 1 || pixelText)
+    {
+        // off the bottom, or wrapping round from above the top like setPixel(x, y + b) does //
+        if(y > LCD_HEIGHT - 1 && y < 256 - 8 && !pixelText) return;
+
+        for(b = 0; b < 8; b++)
+        {
+            if(bits & 1 << b)
+                setPixel(x, y + b);
+        }
+        return;
+    }
+
+    bank = y >> 3;
+    shift = y & 7;
+
+    b = screen[x][bank] | (unsigned char)(bits << shift);
+    if(b != screen[x][bank])
+    {
+        screen[x][bank] = b;
+        touch(x, bank);
+    }
+
+    if(shift && bank < LCD_BANKS - 1)
+    {
+        b = screen[x][bank + 1] | (bits >> (8 - shift));
+        if(b != screen[x][bank + 1])
+        {
+            screen[x][bank + 1] = b;
+            touch(x, bank + 1);
+        }
+    }
 }
 
 /******************************************************************
@@ -35,8 +104,16 @@ LCD::LCD()
 
 void LCD::setPixel(unsigned char x, unsigned char y)
 {
-    if(x <= LCD_WIDTH - 1 && y <= LCD_HEIGHT - 1) 
-        screen[x][y >> 3] |= 1 << (y % 8);
+    if(x <= LCD_WIDTH - 1 && y <= LCD_HEIGHT - 1)
+    {
+        unsigned char b = screen[x][y >> 3] | (1 << (y % 8));
+
+        if(b != screen[x][y >> 3])
+        {
+            screen[x][y >> 3] = b;
+            touch(x, y >> 3);
+        }
+    }
 }
 
 /******************************************************************
@@ -48,8 +125,16 @@ void LCD::setPixel(unsigned char x, unsigned char y)
 
 void LCD::clearPixel(unsigned char x, unsigned char y)
 {
-    if(x <= LCD_WIDTH - 1 && y <= LCD_HEIGHT - 1) 
-        screen[x][y >> 3] &= ~(1 << (y % 8));
+    if(x <= LCD_WIDTH - 1 && y <= LCD_HEIGHT - 1)
+    {
+        unsigned char b = screen[x][y >> 3] & ~(1 << (y % 8));
+
+        if(b != screen[x][y >> 3])
+        {
+            screen[x][y >> 3] = b;
+            touch(x, y >> 3);
+        }
+    }
 }
 
 /******************************************************************
@@ -447,6 +532,12 @@ char LCD::measureCharTiny(char c)
     unsigned char *pFont;
     pFont = (unsigned char*)font4_5;
 
+    if(c >= ' ' && c <= 'z')
+    {
+        unsigned char w = pgm_read_byte(&font4_5_width[c - ' ']);
+        if(w != 0xFF) return w;
+    }
+
     if(c == ' ')
     {
         return 2;
@@ -494,7 +585,7 @@ char LCD::measureCharTiny(char c)
 
 unsigned char LCD::writeCharTiny(unsigned char x, unsigned char y, unsigned char c)
 {
-    uint8_t line, b, len;
+    uint8_t line, len;
     uint8_t *pFont;
     uint8_t ch;
 
@@ -505,40 +596,37 @@ unsigned char LCD::writeCharTiny(unsigned char x, unsigned char y, unsigned char
     
     if(c == '.')
     {
-        setPixel(x, y + 4);
+        column(x, y, 0b10000);
         return 1;
     }
 
     if(c == ':')
     {
-        setPixel(x, y + 1);
-        setPixel(x, y + 3);
+        column(x, y, 0b01010);
         return 1;
     }
 
     if(c == '+')
     {
-        setPixel(x,   y + 2);
-        setPixel(x+1, y + 2);
-        setPixel(x+1, y + 1);
-        setPixel(x+1, y + 3);
-        setPixel(x+2, y + 2);
+        column(x,   y, 0b00100);
+        column(x+1, y, 0b01110);
+        column(x+2, y, 0b00100);
         return 3;
     }
     if(c == '-')
     {
-        setPixel(x,   y + 2);
-        setPixel(x+1, y + 2);
-        setPixel(x+2, y + 2);
+        column(x,   y, 0b00100);
+        column(x+1, y, 0b00100);
+        column(x+2, y, 0b00100);
         return 3;
     }
     if(c == '/')
     {
-        setPixel(x+4, y + 0);
-        setPixel(x+3, y + 1);
-        setPixel(x+2, y + 2);
-        setPixel(x+1, y + 3);
-        setPixel(x,   y + 4);
+        column(x,   y, 0b10000);
+        column(x+1, y, 0b01000);
+        column(x+2, y, 0b00100);
+        column(x+3, y, 0b00010);
+        column(x+4, y, 0b00001);
         return 5;
     }
 
@@ -563,12 +651,7 @@ unsigned char LCD::writeCharTiny(unsigned char x, unsigned char y, unsigned char
     for(line = 0; line < len; line++)
     {
         ch = pgm_read_byte(pFont + c * 6 + line + 1);
-        
-        for(b = 0; b < 5; b++)
-        {
-            if(ch & 1 << b) 
-                setPixel(x + line, y + b);
-        }
+        column(x + line, y, ch & 0x1F);
     }
     return len;
 }
@@ -582,7 +665,7 @@ unsigned char LCD::writeCharTiny(unsigned char x, unsigned char y, unsigned char
 
 void LCD::writeChar(unsigned char x, unsigned char y, unsigned char c)
 {
-    unsigned char line, b;
+    unsigned char line;
     unsigned char *pFont;
     unsigned char ch;
 
@@ -592,12 +675,7 @@ void LCD::writeChar(unsigned char x, unsigned char y, unsigned char c)
     for(line = 0; line < 6; line++)
     {
         ch = pgm_read_byte(pFont + c * 6 + line);
-        
-        for(b = 0; b < 8; b++)
-        {
-            if(ch & 1 << b) 
-                setPixel(x + line, y + b);
-        }
+        column(x + line, y, ch);
     }
 }
 
@@ -765,15 +843,7 @@ char LCD::sgn(char x)
 
 void LCD::drawHighlight(unsigned char x1, unsigned char y1, unsigned char x2, unsigned char y2)
 {
-    unsigned char i, j;
-    
-    for(j = x1; j <= x2; j++)
-    {
-        for(i = y1; i <= y2; i++)
-        {
-            xorPixel(j, i);
-        }
-    }
+    boxBytes(x1, y1, x2, y2, 1);
 }
 
 /******************************************************************
@@ -785,13 +855,43 @@ void LCD::drawHighlight(unsigned char x1, unsigned char y1, unsigned char x2, un
 
 void LCD::eraseBox(unsigned char x1, unsigned char y1, unsigned char x2, unsigned char y2)
 {
-    unsigned char i, j;
-    
-    for(j = x1; j <= x2; j++)
+    boxBytes(x1, y1, x2, y2, 0);
+}
+
+/******************************************************************
+ *
+ *   LCD::boxBytes
+ *   Inverts (invert = 1) or clears a box a bank byte at a time,
+ *   clipped to the screen
+ *
+ ******************************************************************/
+
+void LCD::boxBytes(unsigned char x1, unsigned char y1, unsigned char x2, unsigned char y2, uint8_t invert)
+{
+    unsigned char x, bank, mask, b;
+
+    if(x2 > LCD_WIDTH - 1) x2 = LCD_WIDTH - 1;
+    if(y2 > LCD_HEIGHT - 1) y2 = LCD_HEIGHT - 1;
+    if(x1 > x2 || y1 > y2) return;
+
+    for(bank = y1 >> 3; bank <= (y2 >> 3); bank++)
     {
-        for(i = y1; i <= y2; i++)
+        mask = 0xFF;
+        if(bank == (y1 >> 3)) mask &= 0xFF << (y1 & 7);
+        if(bank == (y2 >> 3)) mask &= 0xFF >> (7 - (y2 & 7));
+
+        for(x = x1; x <= x2; x++)
         {
-            clearPixel(j, i);
+            if(invert)
+                b = screen[x][bank] ^ mask;
+            else
+                b = screen[x][bank] & ~mask;
+
+            if(b != screen[x][bank])
+            {
+                screen[x][bank] = b;
+                touch(x, bank);
+            }
         }
     }
 }
@@ -924,7 +1024,11 @@ void LCD::cls()
     {
         for(i = 0; i < 84; i++)
         {
-            screen[i][j] = 0;
+            if(screen[i][j])
+            {
+                screen[i][j] = 0;
+                touch(i, j);
+            }
         }
     }
 }
@@ -938,43 +1042,456 @@ void LCD::cls()
 /******************************************************************
  *
  *   LCD::update
- *
+ *   Swaps the drawing buffer to the display.  The changed spans are
+ *   copied to the front buffer and sent by the SPI interrupt, so
+ *   drawing can carry on straight away.  If the last frame is still
+ *   going out the swap is left pending for LCD::task.
  *
  ******************************************************************/
 
 void LCD::update()
 {
-    uint8_t i, j, b;
-    
     if(disableUpdate) return;
 
-    setXY(0, 0);
-    
-#ifdef LCD_UPSIDEDOWN
+    if(xferBusy)
+    {
+        swapPending = 1;
+        return;
+    }
 
-    for(j = (LCD_HEIGHT >> 3) - 1; j >= 0; j--)
+    swap();
+}
+
+/******************************************************************
+ *
+ *   LCD::task
+ *   Runs a swap that was deferred by update() and feeds the mirror
+ *
+ ******************************************************************/
+
+void LCD::task()
+{
+    if(swapPending && !xferBusy) swap();
+#ifdef LCD_MIRROR_ENABLED
+    if(mirror) mirrorTask();
+#endif
+}
+
+/******************************************************************
+ *
+ *   LCD::busy
+ *
+ *
+ ******************************************************************/
+
+uint8_t LCD::busy()
+{
+    return xferBusy || swapPending;
+}
+
+/******************************************************************
+ *
+ *   LCD::wait
+ *   Finishes the transfer and any pending swap, for callers about
+ *   to disable interrupts or power down
+ *
+ ******************************************************************/
+
+void LCD::wait()
+{
+    finish();
+
+    if(swapPending)
+    {
+        swap();
+        finish();
+    }
+}
+
+/******************************************************************
+ *
+ *   LCD::finish
+ *   Waits for the frame going out.  With interrupts off the SPI
+ *   interrupt can't run, so the bytes are sent from here instead.
+ *
+ ******************************************************************/
+
+void LCD::finish()
+{
+    while(xferBusy)
+    {
+        if(!(SREG & (1 << SREG_I)) && (SPSR & (1 << SPIF))) spiNext();
+    }
+}
+
+/******************************************************************
+ *
+ *   LCD::swap
+ *   Copies the changed part of each bank to the front buffer,
+ *   trimmed to the bytes that differ from what is on the panel, and
+ *   starts the transfer
+ *
+ ******************************************************************/
+
+void LCD::swap()
+{
+    uint8_t j, x, x1, x2, sreg;
+
+    swapPending = 0;
+    spanCount = 0;
+
+    for(j = 0; j < LCD_BANKS; j++)
     {
-        for(i = LCD_WIDTH - 1; i >= 0; i--)
+        x1 = dirtyMin[j];
+        x2 = dirtyMax[j];
+
+        dirtyMin[j] = 0xFF;
+        dirtyMax[j] = 0;
+
+        if(fullFrames)
+        {
+            x1 = 0;
+            x2 = LCD_WIDTH - 1;
+        }
+        else if(x1 <= x2)
+        {
+            while(x1 <= x2 && screen[x1][j] == front[x1][j]) x1++;
+            while(x2 > x1 && screen[x2][j] == front[x2][j]) x2--;
+        }
+
+        if(x1 > x2) continue;
+
+        for(x = x1; x <= x2; x++) front[x][j] = screen[x][j];
+
+#ifdef LCD_MIRROR_ENABLED
+        if(mirror) // for the next mirror frame //
         {
-            b = swapBits(screen[i][j]);
-//      if(invert) b = ~b;
-            writeByte(b, 1);
+            if(x1 < mirrorMin[j]) mirrorMin[j] = x1;
+            if(x2 > mirrorMax[j]) mirrorMax[j] = x2;
         }
+#endif
+
+        spanBank[spanCount] = j;
+        spanX1[spanCount] = x1;
+        spanX2[spanCount] = x2;
+        spanCount++;
+
+        bytesSent += x2 - x1 + 1;
+    }
+
+    frames++;
+
+    if(spanCount == 0)
+    {
+        frameUs = 0;
+        return;
     }
 
+    sreg = SREG;
+    cli();
+    xferStart = TCNT3;
+    SREG = sreg;
+
+    spanIndex = 0;
+    xferPhase = 0;
+    xferBusy = 1;
+
+    setLow(SPI_CS);
+    setLow(LCD_DC);
+
+    (void)SPSR; // clears a SPIF left over from writeByte
+#ifdef LCD_UPSIDEDOWN
+    SPDR = 0x40 | (LCD_BANKS - 1 - spanBank[0]);
 #else
+    SPDR = 0x40 | spanBank[0];
+#endif
+    SPCR |= (1 << SPIE);
+}
 
-    for(j = 0; j < (LCD_HEIGHT >> 3); j++)
+#ifdef LCD_MIRROR_ENABLED
+/******************************************************************
+ *
+ *   LCD::mirrorStart
+ *   Starts the screen mirror, or asks for a key frame if it's
+ *   already running.  out takes a byte: 1 if it went, 0 to try
+ *   again later, -1 if the host is gone (which stops the mirror).
+ *
+ ******************************************************************/
+
+void LCD::mirrorStart(int8_t (*out)(uint8_t b))
+{
+    if(!mirror)
     {
-        for(i = 0; i < LCD_WIDTH; i++)
+        for(uint8_t j = 0; j < LCD_BANKS; j++)
         {
-            b = screen[i][j];
-//      if(invert) b = ~b;
-            writeByte(b, 1);
+            mirrorMin[j] = 0xFF;
+            mirrorMax[j] = 0;
         }
+        mirrorLen = mirrorPos = 0;
+        mirrorIndex = mirrorCount = 0;
+        mirrorPhase = 0;
     }
-    
+    mirrorOut = out;
+    mirrorKey = 1;
+    mirror = 1;
+}
+
+/******************************************************************
+ *
+ *   LCD::mirrorTask
+ *   Sends what the host will take without waiting, a piece of a
+ *   frame at a time.  Updates swapped while a frame is going out
+ *   are merged into the next one.
+ *
+ ******************************************************************/
+
+void LCD::mirrorTask()
+{
+    for(uint8_t n = 0; mirror && n < LCD_MIRROR_CHUNK; n++)
+    {
+        if(mirrorPos == mirrorLen && !mirrorFill()) return;
+
+        int8_t r = (*mirrorOut)(mirrorBuf[mirrorPos]);
+        if(r == 0) return;
+        if(r < 0)
+        {
+            mirror = 0; // host went away or stopped reading
+            return;
+        }
+        mirrorPos++;
+    }
+}
+
+/******************************************************************
+ *
+ *   LCD::mirrorPut
+ *
+ *
+ ******************************************************************/
+
+void LCD::mirrorPut(uint8_t b)
+{
+    mirrorSum += b;
+    mirrorBytes++;
+    mirrorBuf[mirrorLen++] = b;
+}
+
+/******************************************************************
+ *
+ *   LCD::mirrorFill
+ *   Codes the next piece of a frame into mirrorBuf: the header, a
+ *   span, or the sum.  Returns 0 if there's nothing to send.
+ *
+ *   A5 5A flags seq(2, LE) spans, then for each span: bank, x1,
+ *   length and the bytes coded as runs (80|n-1, byte) and literals
+ *   (n-1, n bytes), n up to 128, then the sum of everything after
+ *   the sync bytes.  Flag 01 marks a key frame holding all banks.
+ *   Empty updates aren't sent, so a gap in seq is a lost frame.
+ *
+ *   The spans are taken when the frame starts, and their bytes are
+ *   read from the front buffer as each span is coded.  A span may
+ *   so carry a newer update than the header; that update is also
+ *   in the next frame.
+ *
+ ******************************************************************/
+
+uint8_t LCD::mirrorFill()
+{
+    uint8_t j, x, x2, n;
+
+    mirrorLen = mirrorPos = 0;
+
+    if(mirrorPhase == 0) // start a frame with whatever changed since the last one
+    {
+        mirrorCount = 0;
+        for(j = 0; j < LCD_BANKS; j++)
+        {
+            if(mirrorKey)
+            {
+                mirrorMin[j] = 0;
+                mirrorMax[j] = LCD_WIDTH - 1;
+            }
+            if(mirrorMin[j] > mirrorMax[j]) continue;
+
+            mirrorBank[mirrorCount] = j;
+            mirrorX1[mirrorCount] = mirrorMin[j];
+            mirrorX2[mirrorCount] = mirrorMax[j];
+            mirrorCount++;
+
+            mirrorMin[j] = 0xFF;
+            mirrorMax[j] = 0;
+        }
+        if(mirrorCount == 0) return 0;
+
+        mirrorBuf[0] = LCD_MIRROR_SYNC1;
+        mirrorBuf[1] = LCD_MIRROR_SYNC2;
+        mirrorLen = 2;
+        mirrorBytes += 2;
+        mirrorSum = 0;
+
+        mirrorPut(mirrorKey ? LCD_MIRROR_KEY : 0);
+        mirrorPut((uint8_t)mirrorSeq);
+        mirrorPut((uint8_t)(mirrorSeq >> 8));
+        mirrorPut(mirrorCount);
+
+        mirrorKey = 0;
+        mirrorIndex = 0;
+        mirrorPhase = 1;
+        return 1;
+    }
+
+    if(mirrorIndex == mirrorCount) // all the spans are out
+    {
+        mirrorPut(mirrorSum);
+        mirrorSeq++;
+        mirrorFrames++;
+        mirrorPhase = 0;
+        return 1;
+    }
+
+    j = mirrorBank[mirrorIndex];
+    x = mirrorX1[mirrorIndex];
+    x2 = mirrorX2[mirrorIndex];
+    mirrorIndex++;
+
+    mirrorPut(j);
+    mirrorPut(x);
+    mirrorPut(x2 - x + 1);
+
+    while(x <= x2)
+    {
+        // run of three or more the same //
+        for(n = 1; x + n <= x2 && n < LCD_MIRROR_MAX && front[x + n][j] == front[x][j]; n++);
+        if(n >= 3)
+        {
+            mirrorPut(LCD_MIRROR_RUN | (n - 1));
+            mirrorPut(front[x][j]);
+            x += n;
+            continue;
+        }
+
+        // otherwise literals up to the next run //
+        for(n = 1; x + n <= x2 && n < LCD_MIRROR_MAX; n++)
+        {
+            if(x + n + 2 <= x2 && front[x + n][j] == front[x + n + 1][j] && front[x + n][j] == front[x + n + 2][j]) break;
+        }
+        mirrorPut(n - 1);
+        while(n--) mirrorPut(front[x++][j]);
+    }
+
+    return 1;
+}
 #endif
+
+/******************************************************************
+ *
+ *   LCD::spiNext
+ *   Called from the SPI interrupt.  At fosc/2 a byte takes 16
+ *   cycles, far less than going in and out of the interrupt, so
+ *   it sends up to LCD_SPI_BURST bytes polling SPIF in between.
+ *   That keeps the cost per byte near a polled flush while other
+ *   interrupts still get in every few microseconds.
+ *
+ ******************************************************************/
+
+void LCD::spiNext()
+{
+    for(uint8_t n = LCD_SPI_BURST; spiPut() && --n; )
+    {
+        while(!(SPSR & (1 << SPIF)));
+    }
+}
+
+/******************************************************************
+ *
+ *   LCD::spiPut
+ *   Sends the next byte of the frame, 0 once it's all gone.  Each
+ *   span is the bank address, the column address, then the data.
+ *   D/C is only sampled on the last bit, so it can change here
+ *   between bytes with CS held low for the whole frame.
+ *
+ ******************************************************************/
+
+uint8_t LCD::spiPut()
+{
+    uint8_t bank = spanBank[spanIndex];
+
+    switch(xferPhase)
+    {
+        case 0:
+#ifdef LCD_UPSIDEDOWN
+            SPDR = 0x80 | (LCD_WIDTH - 1 - spanX2[spanIndex]);
+#else
+            SPDR = 0x80 | spanX1[spanIndex];
+#endif
+            xferPhase = 1;
+            return 1;
+
+        case 1:
+            setHigh(LCD_DC);
+#ifdef LCD_UPSIDEDOWN
+            xferX = spanX2[spanIndex];
+            SPDR = swapBits(front[xferX][bank]);
+#else
+            xferX = spanX1[spanIndex];
+            SPDR = front[xferX][bank];
+#endif
+            xferPhase = 2;
+            return 1;
+
+        default:
+#ifdef LCD_UPSIDEDOWN
+            if(xferX > spanX1[spanIndex])
+            {
+                xferX--;
+                SPDR = swapBits(front[xferX][bank]);
+                return 1;
+            }
+#else
+            if(xferX < spanX2[spanIndex])
+            {
+                xferX++;
+                SPDR = front[xferX][bank];
+                return 1;
+            }
+#endif
+            break;
+    }
+
+    if(++spanIndex < spanCount)
+    {
+        setLow(LCD_DC);
+#ifdef LCD_UPSIDEDOWN
+        SPDR = 0x40 | (LCD_BANKS - 1 - spanBank[spanIndex]);
+#else
+        SPDR = 0x40 | spanBank[spanIndex];
+#endif
+        xferPhase = 0;
+        return 1;
+    }
+
+    setHigh(SPI_CS);
+    SPCR &= ~(1 << SPIE);
+
+    frameUs = TCNT3 - xferStart;
+    if(frameUs > frameUsMax) frameUsMax = frameUs;
+
+    xferBusy = 0;
+    return 0;
+}
+
+/******************************************************************
+ *
+ *   ISR
+ *
+ *   SPI transfer complete - kept here so the per-byte path stays
+ *   inside the LCD code
+ *
+ ******************************************************************/
+
+ISR(SPI_STC_vect)
+{
+    lcd.spiNext();
 }
 
 /************************************************************************************
@@ -1033,7 +1550,10 @@ void LCD::init(uint8_t contrast)
 
     setHigh(LCD_RST);
 
-    SPCR = 0x51;   // enable SPI master, fosc/16 = 1MH
+    wait();
+
+    SPCR = 0x50;   // enable SPI master, fosc/4
+    SPSR = (1 << SPI2X); // doubled to fosc/2 = 4MHz, the PCD8544's limit
 
     writeByte(0x21, 0); // Begin Extended Commands
     writeByte(0xb0 | (0xf & contrast), 0); // Contrast (1-f)
@@ -1045,6 +1565,14 @@ void LCD::init(uint8_t contrast)
     writeByte(0x0c, 0); // 0c = Normal, 0d = Inverted
     backlight(255);
 
+    // the panel was just cleared, so the whole buffer has to go out again //
+    for(uint8_t j = 0; j < LCD_BANKS; j++)
+    {
+        for(uint8_t i = 0; i < LCD_WIDTH; i++) front[i][j] = 0;
+        dirtyMin[j] = 0;
+        dirtyMax[j] = LCD_WIDTH - 1;
+    }
+
     disableUpdate = 0;
 }
 
@@ -1064,6 +1592,8 @@ void LCD::init(uint8_t contrast)
 
 void LCD::writeByte(unsigned char dat, unsigned char dat_type)
 {
+    finish();
+
     setLow(SPI_CS);
     
     if(dat_type == 0) 
@@ -1118,6 +1648,8 @@ void LCD::clear(void)
 
 void LCD::off()
 {
+    wait();
+
     setLow(SPI_CS);
     setLow(SPI_MOSI);
     setLow(SPI_SCK);
@@ -10,7 +10,18 @@
 
 #define LCD_WIDTH 84
 #define LCD_HEIGHT 48
+#define LCD_BANKS (LCD_HEIGHT >> 3)
+
+#define LCD_MIRROR_SYNC1 0xA5
+#define LCD_MIRROR_SYNC2 0x5A
+#define LCD_MIRROR_KEY 0x01
+#define LCD_MIRROR_RUN 0x80
+#define LCD_MIRROR_MAX 128
+#define LCD_MIRROR_CHUNK 96 // bytes coded at a time, a span at most (3 + 85)
+#define LCD_MIRROR_STALL_MS 250 // host not reading for this long stops the mirror
+#define LCD_SPI_BURST 16 // bytes sent per SPI interrupt, ~40us with interrupts held off
 //#define LCD_UPSIDEDOWN
+//#define LCD_MIRROR_ENABLED // screen mirror for the USB serial 'W' command (USB_SERIAL_COMMANDS_ENABLED), ~150 bytes of RAM
 
 #ifndef NOKIA_BW_LCD
 #define NOKIA_BW_LCD
@@ -42,6 +53,10 @@ public:
     void writeCharBig(unsigned char x, unsigned char y, unsigned char c);
     //void drawBMP(unsigned char x, unsigned char y, unsigned char *pBMP);
     void update();
+    void task();
+    uint8_t busy();
+    void wait();
+    void spiNext();
     void init(uint8_t contrast);
     void off(void);
     void cls(void);
@@ -58,8 +73,53 @@ public:
 
     uint8_t disableUpdate;
 
+    uint8_t fullFrames;   // send all 504 bytes on every update, as before (for comparison)
+    uint8_t pixelText;    // draw text a pixel at a time, as before (for comparison)
+    uint32_t bytesSent;
+    uint16_t frames;
+    volatile uint16_t frameUs, frameUsMax;
+
+#ifdef LCD_MIRROR_ENABLED
+    // screen mirror: the spans changed since the last frame, run-length coded, go to mirrorOut //
+    void mirrorStart(int8_t (*out)(uint8_t b));
+    void mirrorTask();
+    uint8_t mirror;
+    uint8_t mirrorKey;    // the next mirrored frame carries the whole screen
+    uint16_t mirrorSeq;
+    uint16_t mirrorFrames;
+    uint32_t mirrorBytes;
+    int8_t (*mirrorOut)(uint8_t b);
+#endif
+
 private:
 
+    // what is on the panel, sent from the SPI interrupt; screen is drawn into //
+    unsigned char front[LCD_WIDTH][LCD_BANKS];
+    uint8_t spanBank[LCD_BANKS], spanX1[LCD_BANKS], spanX2[LCD_BANKS];
+    uint8_t spanCount, spanIndex, xferPhase, xferX;
+    volatile uint8_t xferBusy;
+    uint8_t swapPending;
+    uint16_t xferStart;
+    void swap();
+    void finish();
+    uint8_t spiPut();
+#ifdef LCD_MIRROR_ENABLED
+    uint8_t mirrorMin[LCD_BANKS], mirrorMax[LCD_BANKS]; // changed since the last mirror frame
+    uint8_t mirrorBank[LCD_BANKS], mirrorX1[LCD_BANKS], mirrorX2[LCD_BANKS]; // the frame going out
+    uint8_t mirrorCount, mirrorIndex, mirrorPhase;
+    uint8_t mirrorBuf[LCD_MIRROR_CHUNK], mirrorLen, mirrorPos;
+    uint8_t mirrorSum;
+    uint8_t mirrorFill(void);
+    void mirrorPut(uint8_t b);
+#endif
+
+    // columns changed in each bank since the last update, min > max when clean //
+    uint8_t dirtyMin[LCD_BANKS];
+    uint8_t dirtyMax[LCD_BANKS];
+    void touch(unsigned char x, unsigned char bank);
+    void column(unsigned char x, unsigned char y, unsigned char bits);
+    void boxBytes(unsigned char x1, unsigned char y1, unsigned char x2, unsigned char y2, uint8_t invert);
+
     void writeByte(unsigned char dat, unsigned char dat_type);
     void setXY(unsigned char X, unsigned char Y);
     void clear(void);
@@ -113,6 +113,7 @@ void IR::shutterNow()
     if(make == CANON || make == ALL)
     {        
         cli();
+        clock.hold();
         if(conf.auxPort == AUX_MODE_IR)
         {
             for(int i = 0; i < 16; i++)
@@ -160,6 +161,7 @@ void IR::shutterNow()
     if(make == NIKON || make == ALL)
     {
         cli();
+        clock.hold();
         high40(2000);
         _delay_ms(27.830);
         high40(390);
@@ -175,6 +177,7 @@ void IR::shutterNow()
     if(make == PENTAX || make == ALL)
     {
         cli();
+        clock.hold();
         high38(13000);
         _delay_ms(3);
         
@@ -193,6 +196,7 @@ void IR::shutterNow()
             0, 1, 1, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1 };
         
         cli();
+        clock.hold();
         high40(8972);
         _delay_ms(4.384);
         high40(624);
@@ -219,6 +223,7 @@ void IR::shutterNow()
             0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1 };
         
         cli();
+        clock.hold();
 
         high38(3750);
         _delay_ms(1.890);
@@ -245,6 +250,7 @@ void IR::shutterNow()
             1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 1 };
 
         cli();
+        clock.hold();
 
         for(int j = 0; j < 3; j++)
         {
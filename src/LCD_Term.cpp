@@ -127,6 +127,7 @@ void termPrintStrP(const char *s)
     }
     
     lcd.update();
+    lcd.wait(); // no scheduler here to run a deferred swap
 }
 
 /******************************************************************
@@ -142,5 +143,6 @@ void termClear()
     x = 1;
     y = 1;
     lcd.update();
+    lcd.wait();
 }
 
@@ -38,6 +38,7 @@ MENU::MENU()
     hx2 = 0;
     hy2 = 0;
     m_refresh = 0;
+    cacheMenu = 0;
 }
 
 /******************************************************************
@@ -69,7 +70,7 @@ void MENU::task()
     switch(state)
     {
        case ST_CONT:
-           if(m_refresh) state = ST_MENU;
+           if(m_refresh || !cacheMenu) state = ST_MENU; // redraw if a condition changed the visible items
            switch(key)
            {
               case UP_KEY:
@@ -102,9 +103,10 @@ void MENU::task()
            
            if(ret != FN_CONTINUE) 
            {
-               if(ret == FN_SAVE && func_short)
+               if(ret == FN_SAVE)
                {
-                   (*func_short)();
+                   saves++;
+                   if(func_short) (*func_short)();
                }
                state = ST_MENU;
            }
@@ -116,9 +118,10 @@ void MENU::task()
            
            if(ret != FN_CONTINUE)
            {
-               if(ret == FN_SAVE && func_short)
+               if(ret == FN_SAVE)
                {
-                   (*func_short)();
+                   saves++;
+                   if(func_short) (*func_short)();
                }
                state = ST_MENU;
            }
@@ -129,9 +132,10 @@ void MENU::task()
            first = 0;
            if(ret != FN_CONTINUE)
            {
-               if(ret == FN_SAVE && func_short)
+               if(ret == FN_SAVE)
                {
-                   (*func_short)();
+                   saves++;
+                   if(func_short) (*func_short)();
                }
                state = ST_MENU;
            }
@@ -142,9 +146,10 @@ void MENU::task()
            first = 0;
            if(ret != FN_CONTINUE)
            {
-               if(ret == FN_SAVE && func_short)
+               if(ret == FN_SAVE)
                {
-                   (*func_short)();
+                   saves++;
+                   if(func_short) (*func_short)();
                }
                state = ST_MENU;
            }
@@ -166,7 +171,10 @@ void MENU::task()
                    eeprom_read_block(&tmp, var, 2);
                    
                    if(tmp != e_val) 
+                   {
                        eeprom_write_block(&e_val, var, 2);
+                       cacheMenu = 0;
+                   }
                }
                state = ST_MENU;
            }
@@ -270,9 +278,10 @@ void MENU::task()
 
 void MENU::init(menu_item *newmenu)
 {
-    uint8_t i;
+    uint8_t i, row;
     uint8_t c;
     unsigned char ch, var_len = 0;
+    int16_t y;
     
     menu = newmenu;
     clearHighlight();
@@ -281,15 +290,18 @@ void MENU::init(menu_item *newmenu)
     checkScroll();
     state = ST_CONT;  // We're back in the menu system //
 
+    if(cacheMenu != menu) buildCache(menu);
+
     menuSize = 0;
     
-    for(i = 0; i < MENU_MAX; i++)
+    for(row = 0; row < visibleCount; row++)
     {
-        char *condition;
-        
-        condition = (char*)pgm_read_word(&menu[i].condition);
+        i = visible[row];
+        y = 8 + 9 * (int16_t)row - menuScroll;
+        menuSize++;
+
+        if(y <= -8 || y >= LCD_HEIGHT) continue; // nothing of this row is on screen
 
-        if(!condition || *condition)
         {
             type = pgm_read_byte(&menu[i].type);
             c = pgm_read_byte(&menu[i].name[MENU_NAME_LEN - 2]);
@@ -297,38 +309,29 @@ void MENU::init(menu_item *newmenu)
             if(type == 'E' || type == 'P')  // Edit variable type //
             {
                 unsigned int *var;
-                unsigned int val;
 
                 var = (unsigned int*)pgm_read_word(&menu[i].function);
                 
                 if(type == 'P')
                 {
-                    eeprom_read_block(&val, var, 2);
-                    var = &val;
+                    var = &labelFor[row]; // read from EEPROM when the cache was built
                 }
                 
-                if(type != 'C') var_len = lcd->writeNumber(2 + MENU_NAME_LEN * 6, 8 + 9 * menuSize - menuScroll, *var, c, 'R',false);  //J.R. 2-27-14
+                if(type != 'C') var_len = lcd->writeNumber(2 + MENU_NAME_LEN * 6, y, *var, c, 'R',false);  //J.R. 2-27-14
             }
 
             if(type == 'S' && c == '*') // Display setting selection in place of menu text
             {
                 settings_item *set;
                 set = (settings_item*)pgm_read_word(&menu[i].function);
-                var = (unsigned int*)pgm_read_word(&menu[i].description);
+                uint8_t x = settingLabel(row);
 
-                for(uint8_t x = 0; x < MENU_MAX; x++)
+                if(x != 0xFF)
                 {
-                    if(pgm_read_byte(&set[x].name[0]) == '0') 
-                        break;
-                    
-                    if(pgm_read_byte(&set[x].value) == *var)
+                    for(c = 0; c < MENU_NAME_LEN - 1; c++) // Write settings item text //
                     {
-                        for(c = 0; c < MENU_NAME_LEN - 1; c++) // Write settings item text //
-                        {
-                            ch = pgm_read_byte(&set[x].name[c]);
-                            lcd->writeChar(2 + c * 6, 8 + 9 * menuSize - menuScroll, ch);
-                        }
-                        break;
+                        ch = pgm_read_byte(&set[x].name[c]);
+                        lcd->writeChar(2 + c * 6, y, ch);
                     }
                 }
             } 
@@ -343,18 +346,18 @@ void MENU::init(menu_item *newmenu)
                         if(b == 0 && ch == '-') continue;   //J.R. 11-25-14 
                         n++;  								//J.R. 11-25-14 
                         if(ch == '+') continue;
-                        lcd->writeChar(2 + n * 6, 8 + 9 * menuSize - menuScroll, ch);  //J.R. 11-25-14 
+                        lcd->writeChar(2 + n * 6, y, ch);  //J.R. 11-25-14 
                     }
                 }
                 if(type == 'M')
                 {
-                  lcd->writeChar(2 + (MENU_NAME_LEN - 1) * 6, 8 + 9 * menuSize - menuScroll, '>');
+                  lcd->writeChar(2 + (MENU_NAME_LEN - 1) * 6, y, '>');
                 }
                 ch = pgm_read_byte(&menu[i].name[MENU_NAME_LEN - 2]);                                             
                 if(type == 'C' && (ch == 'M' || ch == 'N'))  //Correction for Bramp Min-Max J.R. 11-25-14 
                 {
-                  //lcd->writeChar(2 + (MENU_NAME_LEN - 2) * 6, 8 + 9 * menuSize - menuScroll, '*');
-                  lcd->eraseBox(2 + (MENU_NAME_LEN - 2) * 6, 8 + 9 * menuSize - menuScroll, 8 + (MENU_NAME_LEN - 2) * 6, 16 + 9 * menuSize - menuScroll);  //J.R.  
+                  //lcd->writeChar(2 + (MENU_NAME_LEN - 2) * 6, y, '*');
+                  lcd->eraseBox(2 + (MENU_NAME_LEN - 2) * 6, y, 8 + (MENU_NAME_LEN - 2) * 6, y + 8);  //J.R.  
                 }
             }
             
@@ -362,21 +365,14 @@ void MENU::init(menu_item *newmenu)
             {
                 settings_item *set;
                 set = (settings_item*)pgm_read_word(&menu[i].function);
-                var = (unsigned int*)pgm_read_word(&menu[i].description);
+                uint8_t x = settingLabel(row);
 
-                for(uint8_t x = 0; x < MENU_MAX; x++)
+                if(x != 0xFF)
                 {
-                    if(pgm_read_byte(&set[x].name[0]) == '0') 
-                        break;
-                    
-                    if(pgm_read_byte(&set[x].value) == *var)
+                    for(c = 0; c < MENU_NAME_LEN - 1; c++) // Write settings item text //
                     {
-                        for(c = 0; c < MENU_NAME_LEN - 1; c++) // Write settings item text //
-                        {
-                            ch = pgm_read_byte(&set[x].name[c]);
-                            lcd->writeChar(2 + (c + 2) * 6, 8 + 9 * menuSize - menuScroll, ch);
-                        }
-                        break;
+                        ch = pgm_read_byte(&set[x].name[c]);
+                        lcd->writeChar(2 + (c + 2) * 6, y, ch);
                     }
                 }
             }
@@ -394,18 +390,14 @@ void MENU::init(menu_item *newmenu)
                   for(c = 0; c < 7; c++) // Write item text //
                   {
                     if(item_name[c] == 0) break;
-                    lcd->writeChar(2 + (c + 6) * 6, 8 + 9 * menuSize - menuScroll, item_name[c]);
+                    lcd->writeChar(2 + (c + 6) * 6, y, item_name[c]);
                   }        
                 }
             }
-            menuSize++;
         }
-        
-        ch = pgm_read_byte(&menu[i + 1]);
-        if(ch == 0) break;
     }
     
-    i++;
+    i = cacheEnd;
     select(menuSelected);
 
     char str[MENU_NAME_LEN];
@@ -479,6 +471,145 @@ void MENU::setBar(char *left, char *right)
   lcd->clearPixel(83, 47); */
 }
 
+/******************************************************************
+ *
+ *   MENU::buildCache
+ *   Walks the menu once to list the visible items, reading 'P'
+ *   values from EEPROM.  'S' labels are looked up on first draw.
+ *
+ ******************************************************************/
+
+void MENU::buildCache(menu_item *cmenu)
+{
+    uint8_t i;
+
+    visibleCount = 0;
+    memset(usedConditions, 0, sizeof(usedConditions));
+
+    for(i = 0; i < MENU_MAX; i++)
+    {
+        uint16_t condition = pgm_read_word(&cmenu[i].condition);
+
+        if(condition && condition <= MENU_CONDITIONS)
+            usedConditions[(condition - 1) >> 3] |= 1 << ((condition - 1) & 7);
+
+        if(itemShown(&cmenu[i]))
+        {
+            visible[visibleCount] = i;
+            labelIndex[visibleCount] = 0xFF;
+            labelFor[visibleCount] = 0;
+
+            if(pgm_read_byte(&cmenu[i].type) == 'P')
+                eeprom_read_block(&labelFor[visibleCount], (void*)pgm_read_word(&cmenu[i].function), 2);
+
+            visibleCount++;
+        }
+        
+        if(pgm_read_byte(&cmenu[i + 1]) == 0) break;
+    }
+
+    cacheEnd = i + 1;
+    cacheMenu = cmenu;
+}
+
+/******************************************************************
+ *
+ *   MENU::settingLabel
+ *   Settings entry matching the bound value of an 'S' row, only
+ *   searched again when the value has changed
+ *
+ ******************************************************************/
+
+uint8_t MENU::settingLabel(uint8_t row)
+{
+    uint8_t i = visible[row];
+    settings_item *set = (settings_item*)pgm_read_word(&menu[i].function);
+    unsigned int *bound = (unsigned int*)pgm_read_word(&menu[i].description);
+
+    if(labelIndex[row] != 0xFF && labelFor[row] == *bound) return labelIndex[row];
+
+    labelIndex[row] = 0xFF;
+    labelFor[row] = *bound;
+
+    for(uint8_t x = 0; x < MENU_MAX; x++)
+    {
+        if(pgm_read_byte(&set[x].name[0]) == '0') 
+            break;
+        
+        if(pgm_read_byte(&set[x].value) == *bound)
+        {
+            labelIndex[row] = x;
+            break;
+        }
+    }
+
+    return labelIndex[row];
+}
+
+/******************************************************************
+ *
+ *   MENU::invalidate
+ *   Drops the visible-item cache, the menu is redrawn on the next
+ *   pass
+ *
+ ******************************************************************/
+
+void MENU::invalidate()
+{
+    cacheMenu = 0;
+}
+
+/******************************************************************
+ *
+ *   MENU::itemShown
+ *   Tests a menu item's condition, either a bit in conditions or
+ *   the address of a flag
+ *
+ ******************************************************************/
+
+uint8_t MENU::itemShown(menu_item *item)
+{
+    uint16_t c = pgm_read_word(&item->condition);
+
+    if(!c) return 1;
+
+    if(c <= MENU_CONDITIONS) return condition(c - 1);
+
+    return *((char*)c) != 0;
+}
+
+/******************************************************************
+ *
+ *   MENU::condition
+ *
+ *
+ ******************************************************************/
+
+uint8_t MENU::condition(uint8_t bit)
+{
+    return (conditions[bit >> 3] & (1 << (bit & 7))) != 0;
+}
+
+/******************************************************************
+ *
+ *   MENU::setCondition
+ *   Only a flip of a condition used by the menu on screen costs a
+ *   rebuild and redraw
+ *
+ ******************************************************************/
+
+void MENU::setCondition(uint8_t bit, uint8_t on)
+{
+    uint8_t mask = 1 << (bit & 7);
+
+    if(((conditions[bit >> 3] & mask) != 0) == (on != 0)) return;
+
+    conditions[bit >> 3] ^= mask;
+    conditionFlips++;
+
+    if(usedConditions[bit >> 3] & mask) invalidate();
+}
+
 /******************************************************************
  *
  *   MENU::getIndex
@@ -490,13 +621,12 @@ uint8_t MENU::getIndex(menu_item *cmenu, uint8_t selected)
 {
     uint8_t index = 0, i = 0;
 
+    if(cmenu == cacheMenu)
+        return selected < visibleCount ? visible[selected] : MENU_MAX;
+
     while (index < MENU_MAX) // determine index //
     {
-        char *condition;
-        
-        condition = (char*)pgm_read_word(&cmenu[index].condition);
-        
-        if(!condition || *condition)
+        if(itemShown(&cmenu[index]))
         {
             if(selected == i) 
                 break;
@@ -521,15 +651,25 @@ uint8_t MENU::getSelected(menu_item *cmenu, uint8_t index)
 {
     uint8_t ind = 0, i = 0;
 
+    if(cmenu == cacheMenu) // visible rows before index, visible[] is in menu order //
+    {
+        uint8_t lo = 0, hi = visibleCount;
+
+        while(lo < hi)
+        {
+            uint8_t mid = (lo + hi) >> 1;
+            if(visible[mid] < index) lo = mid + 1; else hi = mid;
+        }
+
+        return lo;
+    }
+
     while (ind < MENU_MAX) // determine index //
     {
-        uint8_t *condition;
-        condition = (uint8_t*)pgm_read_word(&cmenu[ind].condition);
-        
         if(index == ind) 
             break;
         
-        if(!condition || *condition)
+        if(itemShown(&cmenu[ind]))
         {
             i++;
         }
@@ -651,7 +791,7 @@ void MENU::click()
                    desc_addr = (unsigned char (*))pgm_read_word(&menu[index].description);
                    b = 0;
 
-                   if(desc_addr > 0)
+                   if(desc_addr)
                    {
                        while(b < MENU_NAME_LEN)
                        {
@@ -16,6 +16,12 @@
 
 #define MAX_ALERTS 5
 
+// menu_item.condition is either the address of a flag or, for values up to
+// MENU_CONDITIONS, a bit in MENU's condition bitfield (RAM starts above that)
+#define MENU_CONDITIONS 40
+#define MENU_CONDITION_BYTES ((MENU_CONDITIONS + 7) / 8)
+#define MENU_CONDITION(bit) ((void*)((bit) + 1))
+
 #define ST_CONT 0
 #define ST_MENU 1
 #define ST_EDIT 2
@@ -79,6 +85,9 @@ public:
     void spawn(void *function);
     void submenu(void *new_menu);
     void refresh();
+    void invalidate();
+    uint8_t condition(uint8_t bit);
+    void setCondition(uint8_t bit, uint8_t on);
     void up();
     void down();
     void back();
@@ -103,6 +112,8 @@ public:
     void blink();
     
     uint8_t unusedKey;
+    uint16_t conditionFlips;
+    uint8_t saves;                 // counts values saved from edit screens
 
 private:
     void menu_push(void *item_addr, char selection, uint8_t type);
@@ -110,6 +121,9 @@ private:
     char checkScroll();
     uint8_t getIndex(menu_item *cmenu, uint8_t selected);
     uint8_t getSelected(menu_item *cmenu, uint8_t index);
+    void buildCache(menu_item *cmenu);
+    uint8_t itemShown(menu_item *item);
+    uint8_t settingLabel(uint8_t row);
 
     menu_stack stack[MENU_STACK_SIZE]; // stack for nested menus
     uint8_t stack_counter;
@@ -119,6 +133,16 @@ private:
     char menuSize;
     menu_item *menu;
 
+    // visible-item cache for the current menu, rebuilt when menu conditions change //
+    menu_item *cacheMenu;           // menu the cache was built for, 0 when stale
+    uint8_t cacheEnd;               // index of the closing 'B'/'F' item
+    uint8_t visibleCount;
+    uint8_t usedConditions[MENU_CONDITION_BYTES]; // condition bits tested by the cached menu
+    uint8_t conditions[MENU_CONDITION_BYTES];
+    uint8_t visible[MENU_MAX];      // menu index of each visible row
+    uint8_t labelIndex[MENU_MAX];   // 'S' rows: settings entry for the value below, 0xFF for none
+    unsigned int labelFor[MENU_MAX]; // 'S' rows: bound value the label was found for, 'P' rows: EEPROM value
+
     char state;
     char m_refresh;
     unsigned char type;
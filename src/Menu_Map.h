@@ -288,78 +288,78 @@ const dynamicItem_t dyn_hdr_exps PROGMEM =
 const menu_item menu_timelapse_night_exp[]PROGMEM =
 {
     { "Shutter    +", 'D', (void*)&dyn_night_shutter, (void*)&timer.current.nightShutter, 0, 0 },
-    { "ISO        +", 'D', (void*)&dyn_night_iso, (void*)&timer.current.nightISO, 0, (void*)&rampISO },
-    { "Aperture   +", 'D', (void*)&dyn_night_aperture, (void*)&timer.current.nightAperture, 0, (void*)&rampAperture },
+    { "ISO        +", 'D', (void*)&dyn_night_iso, (void*)&timer.current.nightISO, 0, MENU_CONDITION(COND_RAMP_ISO) },
+    { "Aperture   +", 'D', (void*)&dyn_night_aperture, (void*)&timer.current.nightAperture, 0, MENU_CONDITION(COND_RAMP_APERTURE) },
     { "\0           ", 'V', 0, 0, 0 }
 };
 const menu_item menu_timelapse[]PROGMEM =
 {
     { "Mode       *", 'S', (void*)settings_timer_mode, (void*)&timer.current.Mode, 0, 0 },
-    { "Method     *", 'S', (void*)settings_bramp_method, (void*)&timer.current.brampMethod, 0, (void*)&modeRamp },
+    { "Method     *", 'S', (void*)settings_bramp_method, (void*)&timer.current.brampMethod, 0, MENU_CONDITION(COND_MODE_RAMP) },
     { "Delay      T", 'E', (void*)&timer.current.Delay, (void*)STR_TIME, 0, 0 },
-    { "Length     H", 'E', (void*)&timer.current.Duration, (void*)STR_TIME_HOURS, 0, (void*)&modeRamp },
-    { "Frames     U", 'E', (void*)&timer.current.Photos, (void*)STR_PHOTOS, 0, (void*)&modeNoRamp },
-    { "Intrvl Mode ", 'S', (void*)settings_interval_mode, (void*)&timer.current.IntervalMode, 0, (void*)&modeRamp },
-    { "Intrvl     F", 'E', (void*)&timer.current.Gap, (void*)STR_TIME_TENTHS, 0, (void*)&showGap },
-    { "Int Max    F", 'E', (void*)&timer.current.Gap, (void*)STR_TIME_TENTHS, 0, (void*)&showIntervalMaxMin },
-    { "Int Min    F", 'E', (void*)&timer.current.GapMin, (void*)STR_TIME_TENTHS, 0, (void*)&showIntervalMaxMin },
-    { "HDR Exp's  +", 'D', (void*)&dyn_hdr_exps,    (void*)&timer.current.Exps, 0, (void*)&modeHDR },
-    { "Mid Tv     +", 'D', (void*)&dyn_hdr_tv,            (void*)&timer.current.Exp, 0, (void*)&modeHDR },
-    { "Tv         +", 'D', (void*)&dyn_tv,            (void*)&timer.current.Exp, 0, (void*)&modeStandardExp },
-    { "S          +", 'D', (void*)&dyn_tv,            (void*)&timer.current.Exp, 0, (void*)&modeStandardExpNikon },
-    { "Bulb       F", 'E', (void*)&timer.current.ArbExp,  (void*)STR_TIME_TENTHS, 0, (void*)&modeStandardExpArb },
-    { "Bracket    +", 'D', (void*)&dyn_bracket,            (void*)&timer.current.Bracket, 0, (void*)&modeHDR },
-    { "StartTv    +", 'D', (void*)&dyn_bulb, (void*)&timer.current.BulbStart, 0, (void*)&modeRampNormal },
-    { "StartTv    +", 'D', (void*)&dyn_ramp_ext, (void*)&timer.current.BulbStart, 0, (void*)&modeRampExtended },
-    { "Night Target", 'S', (void*)settings_bramp_target, (void*)&timer.current.nightMode, 0, (void*)&brampAuto },
-    { "  Night Exp ", 'M', (void*)menu_timelapse_night_exp, 0, 0, (void*)&rampTargetCustom },
-    { "-By        T", 'E', (void*)&timer.current.Key[0], (void*)STR_TIME_SINCE_START, 0, (void*)&brampKeyframe },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[0], 0, (void*)&brampKeyframe },
-    { "-By        T", 'E', (void*)&timer.current.Key[1], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb1 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[1], 0, (void*)&bulb1 },
-    { "-By        T", 'E', (void*)&timer.current.Key[2], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb2 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[2], 0, (void*)&bulb2 },
-    { "-By        T", 'E', (void*)&timer.current.Key[3], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb3 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[3], 0, (void*)&bulb3 },
-    { "-By        T", 'E', (void*)&timer.current.Key[4], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb4 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[4], 0, (void*)&bulb4 },
-    { "-By        T", 'E', (void*)&timer.current.Key[5], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb5 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[5], 0, (void*)&bulb5 },
-    { "-By        T", 'E', (void*)&timer.current.Key[6], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb6 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[6], 0, (void*)&bulb6 },
-    { "-By        T", 'E', (void*)&timer.current.Key[7], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb7 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[7], 0, (void*)&bulb7 },
-    { "-By        T", 'E', (void*)&timer.current.Key[8], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb8 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[8], 0, (void*)&bulb8 },
-    { "-By        T", 'E', (void*)&timer.current.Key[9], (void*)STR_TIME_SINCE_START, 0, (void*)&bulb9 },
-    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[9], 0, (void*)&bulb9 },
+    { "Length     H", 'E', (void*)&timer.current.Duration, (void*)STR_TIME_HOURS, 0, MENU_CONDITION(COND_MODE_RAMP) },
+    { "Frames     U", 'E', (void*)&timer.current.Photos, (void*)STR_PHOTOS, 0, MENU_CONDITION(COND_MODE_NO_RAMP) },
+    { "Intrvl Mode ", 'S', (void*)settings_interval_mode, (void*)&timer.current.IntervalMode, 0, MENU_CONDITION(COND_MODE_RAMP) },
+    { "Intrvl     F", 'E', (void*)&timer.current.Gap, (void*)STR_TIME_TENTHS, 0, MENU_CONDITION(COND_SHOW_GAP) },
+    { "Int Max    F", 'E', (void*)&timer.current.Gap, (void*)STR_TIME_TENTHS, 0, MENU_CONDITION(COND_SHOW_INTERVAL_MAX_MIN) },
+    { "Int Min    F", 'E', (void*)&timer.current.GapMin, (void*)STR_TIME_TENTHS, 0, MENU_CONDITION(COND_SHOW_INTERVAL_MAX_MIN) },
+    { "HDR Exp's  +", 'D', (void*)&dyn_hdr_exps,    (void*)&timer.current.Exps, 0, MENU_CONDITION(COND_MODE_HDR) },
+    { "Mid Tv     +", 'D', (void*)&dyn_hdr_tv,            (void*)&timer.current.Exp, 0, MENU_CONDITION(COND_MODE_HDR) },
+    { "Tv         +", 'D', (void*)&dyn_tv,            (void*)&timer.current.Exp, 0, MENU_CONDITION(COND_MODE_STANDARD_EXP) },
+    { "S          +", 'D', (void*)&dyn_tv,            (void*)&timer.current.Exp, 0, MENU_CONDITION(COND_MODE_STANDARD_EXP_NIKON) },
+    { "Bulb       F", 'E', (void*)&timer.current.ArbExp,  (void*)STR_TIME_TENTHS, 0, MENU_CONDITION(COND_MODE_STANDARD_EXP_ARB) },
+    { "Bracket    +", 'D', (void*)&dyn_bracket,            (void*)&timer.current.Bracket, 0, MENU_CONDITION(COND_MODE_HDR) },
+    { "StartTv    +", 'D', (void*)&dyn_bulb, (void*)&timer.current.BulbStart, 0, MENU_CONDITION(COND_MODE_RAMP_NORMAL) },
+    { "StartTv    +", 'D', (void*)&dyn_ramp_ext, (void*)&timer.current.BulbStart, 0, MENU_CONDITION(COND_MODE_RAMP_EXTENDED) },
+    { "Night Target", 'S', (void*)settings_bramp_target, (void*)&timer.current.nightMode, 0, MENU_CONDITION(COND_BRAMP_AUTO) },
+    { "  Night Exp ", 'M', (void*)menu_timelapse_night_exp, 0, 0, MENU_CONDITION(COND_RAMP_TARGET_CUSTOM) },
+    { "-By        T", 'E', (void*)&timer.current.Key[0], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BRAMP_KEYFRAME) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[0], 0, MENU_CONDITION(COND_BRAMP_KEYFRAME) },
+    { "-By        T", 'E', (void*)&timer.current.Key[1], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB1) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[1], 0, MENU_CONDITION(COND_BULB1) },
+    { "-By        T", 'E', (void*)&timer.current.Key[2], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB2) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[2], 0, MENU_CONDITION(COND_BULB2) },
+    { "-By        T", 'E', (void*)&timer.current.Key[3], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB3) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[3], 0, MENU_CONDITION(COND_BULB3) },
+    { "-By        T", 'E', (void*)&timer.current.Key[4], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB4) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[4], 0, MENU_CONDITION(COND_BULB4) },
+    { "-By        T", 'E', (void*)&timer.current.Key[5], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB5) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[5], 0, MENU_CONDITION(COND_BULB5) },
+    { "-By        T", 'E', (void*)&timer.current.Key[6], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB6) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[6], 0, MENU_CONDITION(COND_BULB6) },
+    { "-By        T", 'E', (void*)&timer.current.Key[7], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB7) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[7], 0, MENU_CONDITION(COND_BULB7) },
+    { "-By        T", 'E', (void*)&timer.current.Key[8], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB8) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[8], 0, MENU_CONDITION(COND_BULB8) },
+    { "-By        T", 'E', (void*)&timer.current.Key[9], (void*)STR_TIME_SINCE_START, 0, MENU_CONDITION(COND_BULB9) },
+    { "  Ramp     +", 'D', (void*)&dyn_stops, (void*)&timer.current.Bulb[9], 0, MENU_CONDITION(COND_BULB9) },
     { "\0           ", 'F', (void*)&runHandler, (void*)STR_OPTIONS, 0, (void*)STR_RUN }
 };
 
 const menu_item menu_trigger[]PROGMEM =
 {
-    { "Cable Remote", 'F', (void*)cableRelease, 0, 0, (void*)&timerNotRunning },
-    { "IR Remote   ", 'F', (void*)IRremote, 0, 0, (void*)&timerNotRunning },
-    { "BT Remote   ", 'F', (void*)cableReleaseRemote, 0, 0, (void*)&showRemoteStart },
-    { "Light/Motion", 'F', (void*)lightTrigger, 0, 0, (void*)&timerNotRunning },
-    { "Focus Stack ", 'F', (void*)focusStack, 0, 0, (void*)&camera.supports.focus },
-    { "Video       ", 'F', (void*)videoRemote, 0, 0, (void*)&camera.supports.video },
-    { "Remote Video", 'F', (void*)videoRemoteBT, 0, 0, (void*)&showRemoteStart },
+    { "Cable Remote", 'F', (void*)cableRelease, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
+    { "IR Remote   ", 'F', (void*)IRremote, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
+    { "BT Remote   ", 'F', (void*)cableReleaseRemote, 0, 0, MENU_CONDITION(COND_SHOW_REMOTE_START) },
+    { "Light/Motion", 'F', (void*)lightTrigger, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
+    { "Focus Stack ", 'F', (void*)focusStack, 0, 0, MENU_CONDITION(COND_CAMERA_FOCUS) },
+    { "Video       ", 'F', (void*)videoRemote, 0, 0, MENU_CONDITION(COND_CAMERA_VIDEO) },
+    { "Remote Video", 'F', (void*)videoRemoteBT, 0, 0, MENU_CONDITION(COND_SHOW_REMOTE_START) },
     { "\0           ", 'V', 0, 0, 0 }
 };
 
 const menu_item menu_trigger_running[]PROGMEM =
 {
-    { "BT Remote   ", 'F', (void*)cableReleaseRemote, 0, 0, (void*)&showRemoteStart },
-    { "Remote Video", 'F', (void*)videoRemoteBT, 0, 0, (void*)&showRemoteStart },
+    { "BT Remote   ", 'F', (void*)cableReleaseRemote, 0, 0, MENU_CONDITION(COND_SHOW_REMOTE_START) },
+    { "Remote Video", 'F', (void*)videoRemoteBT, 0, 0, MENU_CONDITION(COND_SHOW_REMOTE_START) },
     { "\0           ", 'V', 0, 0, 0 }
 };
 
 const menu_item menu_timelapse_options[]PROGMEM =
 {
     { "Main Menu   ", 'F', (void*)backToMain, 0, 0, 0 },
-    { "Guided Mode ", 'F', (void*)timerToGuided, 0, 0, (void*)&brampNotGuided },
-    { "Auto Mode   ", 'F', (void*)timerToAuto, 0, 0, (void*)&brampNotAuto },
+    { "Guided Mode ", 'F', (void*)timerToGuided, 0, 0, MENU_CONDITION(COND_BRAMP_NOT_GUIDED) },
+    { "Auto Mode   ", 'F', (void*)timerToAuto, 0, 0, MENU_CONDITION(COND_BRAMP_NOT_AUTO) },
     { "Stop T-lapse", 'F', (void*)timerStop, 0, 0, 0 },
     { "\0           ", 'V', 0, 0, 0 }
 };
@@ -651,8 +651,8 @@ const menu_item menu_settings_display[]PROGMEM =
 const menu_item menu_settings_camera[]PROGMEM =
 {
     { "Camera Make ", 'S', (void*)menu_settings_camera_make, (void*)&conf.camera.cameraMake, (void*)settings_update, 0 },
-    { "Run Autoconf", 'F', (void*)autoConfigureCameraTiming, 0, 0, (void*)&timerNotRunning },
-    { "Nikon USB   ", 'S', (void*)menu_settings_nikon_usb_capture, (void*)&conf.camera.nikonUSB, (void*)settings_update, (void*)&cameraMakeNikon },
+    { "Run Autoconf", 'F', (void*)autoConfigureCameraTiming, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
+    { "Nikon USB   ", 'S', (void*)menu_settings_nikon_usb_capture, (void*)&conf.camera.nikonUSB, (void*)settings_update, MENU_CONDITION(COND_CAMERA_MAKE_NIKON) },
     { "Camera FPS  ", 'S', (void*)menu_settings_camera_fps, (void*)&conf.camera.cameraFPS, (void*)settings_update, 0 },
     { "Bulb Mode   ", 'S', (void*)menu_settings_bulb_mode, (void*)&conf.camera.bulbMode, (void*)settings_update, 0 },
     { "-Bulb Offset", 'C', (void*)&conf.camera.bulbOffset, (void*)STR_BULB_OFFSET, (void*)settings_update, 0 },
@@ -702,15 +702,15 @@ const menu_item menu_development[]PROGMEM =
     { "Dev Mode LED", 'S', (void*)menu_settings_dev_mode, (void*)&conf.devMode, (void*)settings_update, 0 },
     { "Debug Mode  ", 'S', (void*)menu_settings_debug_mode, (void*)&conf.debugEnabled, (void*)settings_update, 0 },
     { "KeyframeEdit", 'F', (void*)keyFrameEditor, 0, 0, 0 },
-    { "Shutter Test", 'F', (void*)shutterTest, 0, 0, (void*)&timerNotRunning },
+    { "Shutter Test", 'F', (void*)shutterTest, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
 #ifdef PRODUCTION
-    { "4 Hour Light", 'F', (void*)lightTest, 0, 0, (void*)&timerNotRunning },
+    { "4 Hour Light", 'F', (void*)lightTest, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
 #endif
-    { "Light Meter ", 'F', (void*)lightMeter, 0, 0, (void*)&timerNotRunning },
+    { "Light Meter ", 'F', (void*)lightMeter, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
 //    { "BT Flood    ", 'F', (void*)btFloodTest, 0, 0, 0 },
-    { "Reset All   ", 'F', (void*)factoryReset, 0, 0, (void*)&timerNotRunning },
+    { "Reset All   ", 'F', (void*)factoryReset, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
 //    { "WDT Reset   ", 'F', (void*)wdtReset, 0, 0, 0 },
-    { "Program TL  ", 'F', (void*)hardware_bootloader, 0, 0, (void*)&timerNotRunning },
+    { "Program TL  ", 'F', (void*)hardware_bootloader, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
     { "\0           ", 'V', 0, 0, 0 }
 };
 
@@ -728,28 +728,28 @@ const menu_item menu_settings[]PROGMEM =
 
 const menu_item menu_main[]PROGMEM =
 {
-    { "Trigger     ", 'M', (void*)menu_trigger, 0, 0, (void*)&timerNotRunning },
-    { "Timelapse   ", 'M', (void*)menu_timelapse, 0, 0, (void*)&timerNotRunning },
-    { "Timelapse   ", 'F', (void*)timerStatus, 0, 0, (void*)&timer.running },
+    { "Trigger     ", 'M', (void*)menu_trigger, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
+    { "Timelapse   ", 'M', (void*)menu_timelapse, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
+    { "Timelapse   ", 'F', (void*)timerStatus, 0, 0, MENU_CONDITION(COND_TIMER_RUNNING) },
     { "Connect     ", 'M', (void*)menu_connect, 0, 0, 0 },
     { "Settings    ", 'M', (void*)menu_settings, 0, 0, 0 },
-    { "Power Off   ", 'F', (void*)hardware_off, 0, 0, (void*)&timerNotRunning },
+    { "Power Off   ", 'F', (void*)hardware_off, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
     { "\0           ", 'V', 0, 0, 0 }
 };
 
 const menu_item menu_options[]PROGMEM =
 {
-    { "Stop Timer  ", 'F', (void*)&timerStop, 0, 0, (void*)&timer.running },
-    { "Remote Info ", 'F', (void*)&timerStatusRemote, 0, 0, (void*)&showRemoteInfo },
-    { "Start Remote", 'F', (void*)&timerRemoteStart, 0, 0, (void*)&showRemoteStart },
-    { "Add Keyframe", 'F', (void*)&shutter_addKeyframe, 0, 0, (void*)&modeRampKeyAdd },
-    { "Del Keyframe", 'F', (void*)&shutter_removeKeyframe, 0, 0, (void*)&modeRampKeyDel },
+    { "Stop Timer  ", 'F', (void*)&timerStop, 0, 0, MENU_CONDITION(COND_TIMER_RUNNING) },
+    { "Remote Info ", 'F', (void*)&timerStatusRemote, 0, 0, MENU_CONDITION(COND_SHOW_REMOTE_INFO) },
+    { "Start Remote", 'F', (void*)&timerRemoteStart, 0, 0, MENU_CONDITION(COND_SHOW_REMOTE_START) },
+    { "Add Keyframe", 'F', (void*)&shutter_addKeyframe, 0, 0, MENU_CONDITION(COND_MODE_RAMP_KEY_ADD) },
+    { "Del Keyframe", 'F', (void*)&shutter_removeKeyframe, 0, 0, MENU_CONDITION(COND_MODE_RAMP_KEY_DEL) },
 //    { "View Details", 'F', (void*)&viewSeconds, 0, 0, 0 },
-    { "Load Saved..", 'F', (void*)&shutter_load, 0, 0, (void*)&timerNotRunning },
+    { "Load Saved..", 'F', (void*)&shutter_load, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
     { "Save As..   ", 'F', (void*)&shutter_saveAs, 0, 0, 0 },
-    { "Save        ", 'F', (void*)&timerSaveCurrent, 0, 0, (void*)&timer.currentId },
+    { "Save        ", 'F', (void*)&timerSaveCurrent, 0, 0, MENU_CONDITION(COND_PROGRAM_LOADED) },
     { "Save Default", 'F', (void*)&timerSaveDefault, 0, 0, 0 },
-    { "Revert      ", 'F', (void*)&timerRevert, 0, 0, (void*)&timerNotRunning },
+    { "Revert      ", 'F', (void*)&timerRevert, 0, 0, MENU_CONDITION(COND_TIMER_NOT_RUNNING) },
     { "Settings    ", 'M', (void*)menu_settings_timelapse, 0, 0, 0 },
     { "\0OPTIONS\0   ", 'F', (void*)&menuBack, (void*)STR_RETURN, 0, (void*)STR_NULL }
 };
@@ -9,10 +9,12 @@
 #include "tldefs.h"
 #include "debug.h"
 #include "PTP_Lists.h"
+#include "notify.h"
 //#define EXTENDED_DEBUG
 
 extern settings_t conf;
 extern Clock clock;
+extern Notify notify;
 
 uint8_t isoAvail[32];
 uint8_t isoAvailCount;
@@ -40,6 +42,12 @@ uint32_t currentObject;
 uint8_t lvOCmode;
 uint8_t supports_nikon_capture;
 
+// time base for the transaction statistics in PTP_Driver.c
+uint32_t PTP_Clock(void)
+{
+	return clock.Ms();
+}
+
 PTP::PTP(void)
 {
 	static_ready = 0;
@@ -49,6 +57,10 @@ PTP::PTP(void)
 	shutterAvailCount = 0;
 	PTP_protocol = 0;
 	currentObject = 0;
+	pollInterval = PTP_POLL_MIN_MS;
+	pollExpedite = 0;
+	nextPoll = 0;
+	expectAt = 0;
 }
 
 uint8_t PTP::bulbMax() // 4
@@ -755,6 +767,7 @@ uint8_t PTP::init()
 		false,	//.cameraReady
 		false	//.event
 	};	
+	uint8_t make = conf.camera.cameraMake;
 	if(strncmp(PTP_CameraMake, "Canon", 5) == 0) // This should be done with VendorID instead
 	{
 		conf.camera.cameraMake = CANON;
@@ -763,6 +776,7 @@ uint8_t PTP::init()
 	{
 		conf.camera.cameraMake = NIKON;
 	}
+	if(conf.camera.cameraMake != make) notify.changed(WATCH_CAMERA_MAKE);
 
 	if(conf.camera.cameraMake == CANON)
 	{
@@ -885,6 +899,8 @@ uint8_t PTP::init()
 	ready = 1;
 	modeLiveView = false;
 	recording = false;
+	notify.changed(WATCH_LIVEVIEW);
+	notify.changed(WATCH_VIDEO);
 	checkEvent();
 
 	return 0;
@@ -928,6 +944,7 @@ uint8_t PTP::liveView(uint8_t on)
 	}
 	else
 	{
+		if(modeLiveView != on) notify.changed(WATCH_LIVEVIEW);
 		modeLiveView = on;
 	}
 	return 0;	
@@ -1028,6 +1045,133 @@ uint8_t PTP::blockWhileBusy(uint16_t timeoutMS)
 	return 1;
 }
 
+// Called every main loop; decides when to actually query the camera.
+// Polls immediately when the interrupt pipe has data or after the bulb
+// closes, tightens when an event is expected, and otherwise backs off
+// exponentially while the camera is idle.
+uint8_t PTP::pollTask()
+{
+	uint8_t ret, pending, wasBusy;
+	uint32_t now = clock.Ms();
+
+	if(now - pollRateStart >= 1000 || now < pollRateStart)
+	{
+		pollRate = pollCount; // polls per second
+		pollCount = 0;
+		pollRateStart = now;
+	}
+
+	if(ready == 0 || bulb_open)
+	{
+		lastCheck = now;
+		return 0;
+	}
+
+	pending = PTP_EventPending();
+
+	// the clock may have been reset since the last poll, so only wait if nextPoll is still within range
+	if(!pending && !pollExpedite && nextPoll > now && nextPoll - now <= PTP_POLL_MAX_MS)
+	{
+		lastCheck = now;
+		return 0;
+	}
+
+	pollExpedite = false;
+	eventSeen = false;
+	eventRead = false;
+	wasBusy = busy;
+
+	ret = checkEvent();
+	if(pending && !eventRead)
+	{
+		// checkEvent fetched the events with a transaction but left the pipe's notice; clear it,
+		// and since another may have come in behind it, run the transaction again next pass
+		uint32_t event_value;
+		if(PTP_GetEvent(&event_value))
+		{
+			eventSeen = true;
+			pollExpedite = true;
+		}
+	}
+	pollCount++;
+
+	if(eventSeen || (wasBusy && !busy))
+	{
+		// the event happened sometime after we last looked
+		if(pending)
+			noticeLatency = (uint16_t)(now - lastCheck);
+		else
+			noticeLatency = (uint16_t)(now - lastPoll);
+		if(noticeLatency > noticeLatencyMax) noticeLatencyMax = noticeLatency;
+		expectAt = 0;
+		pollInterval = PTP_POLL_MIN_MS;
+	}
+	else if(expectAt && now >= expectAt)
+	{
+		pollInterval = PTP_POLL_MIN_MS;
+		if(now - expectAt > (uint32_t)BUSY_TIMEOUT_SECONDS * 1000) expectAt = 0; // it isn't coming
+	}
+	else if(busy && !expectAt)
+	{
+		pollInterval = PTP_POLL_BUSY_MS;
+	}
+	else
+	{
+		pollInterval <<= 1;
+		if(pollInterval > PTP_POLL_MAX_MS) pollInterval = PTP_POLL_MAX_MS;
+	}
+
+	nextPoll = now + pollInterval;
+	if(expectAt && expectAt > now && expectAt < nextPoll) nextPoll = expectAt;
+
+	lastPoll = now;
+	lastCheck = now;
+	return ret;
+}
+
+// Lets the poller back off during a long exposure and tighten when it's due
+void PTP::expectEvent(uint32_t inMs)
+{
+	expectAt = clock.Ms() + inMs;
+	if(expectAt == 0) expectAt = 1;
+}
+
+// Reads and handles one event from the interrupt pipe, for cameras
+// without an event transaction.  Notes that the pipe was read so
+// pollTask doesn't clear it again.
+uint8_t PTP::pipeEvent()
+{
+	uint16_t tevent;
+	uint32_t event_value;
+
+	eventRead = true;
+	if(!(tevent = PTP_GetEvent(&event_value))) return 0;
+
+	busy = false;
+	eventSeen = true;
+	DEBUG(PSTR("Received Asynchronous Event!\r\n"));
+	switch(tevent)
+	{
+		case PTP_EC_OBJECT_CREATED:
+			currentObject = event_value; // Save the object ID for later retrieving the thumbnail
+			DEBUG(PSTR("\r\n Object added: "));
+			sendHex((char *)&currentObject);
+			break;
+		case PTP_EC_PROPERTY_CHANGED:
+			PTP_need_update = true;
+			DEBUG(PSTR("\r\n Property: "));
+			sendHex((char *)&event_value);
+			break;
+		default:
+			DEBUG(PSTR("\r\n Event: "));
+			sendHex((char *)&tevent);
+			DEBUG(PSTR("\r\n Param: "));
+			sendHex((char *)&event_value);
+			break;
+	}
+	return 1;
+}
+
 uint8_t PTP::checkEvent()
 {
 	uint8_t ret = 0;
@@ -1090,6 +1234,7 @@ uint8_t PTP::checkEvent()
 				i += sizeof(uint16_t);
 				memcpy(&event_value, &PTP_Buffer[i], sizeof(uint32_t));
 				i += sizeof(uint32_t);
+				eventSeen = true;
 				switch(tevent)
 				{
 					case PTP_EC_OBJECT_CREATED:
@@ -1119,38 +1264,17 @@ uint8_t PTP::checkEvent()
 				PTP_need_update = true;
 				count = 0;
 			}
-			uint16_t tevent;
-			if((tevent = PTP_GetEvent(&event_value)))
-			{
-				busy = false;
-				DEBUG(PSTR("Received Asynchronous Event!\r\n"));
-				switch(tevent)
-				{
-					case PTP_EC_OBJECT_CREATED:
-						busy = false;
-						currentObject = event_value; // Save the object ID for later retrieving the thumbnail
-						DEBUG(PSTR("\r\n Object added: "));
-						sendHex((char *)&currentObject);
-						break;
-					case PTP_EC_PROPERTY_CHANGED:
-						PTP_need_update = true;
-						DEBUG(PSTR("\r\n Property: "));
-						sendHex((char *)&event_value);
-						break;
-					default:
-						DEBUG(PSTR("\r\n Event: "));
-						sendHex((char *)&tevent);
-						DEBUG(PSTR("\r\n Param: "));
-						sendHex((char *)&event_value);
-						break;
-				}
-			}
+			pipeEvent();
 			//PTP_need_update = true;
 		}
 		if(PTP_need_update) updatePtpParameters();
 		return ret;
 	}
-	if(PTP_protocol != PROTOCOL_EOS) return 0;
+	if(PTP_protocol != PROTOCOL_EOS)
+	{
+		pipeEvent(); // generic PTP only reports events on the pipe
+		return 0;
+	}
 
 	ret = PTP_FIRST_TIME; // CANON ==================================================================
 	do {
@@ -1308,6 +1432,7 @@ uint8_t PTP::checkEvent()
 
 			if(event_type == EOS_EC_PROPERTY_CHANGE)
 			{
+				eventSeen = true;
 				switch(event_item)
 				{
 					case EOS_DPC_ISO:
@@ -1344,6 +1469,7 @@ uint8_t PTP::checkEvent()
 						break;
 					case EOS_DPC_LiveView:
 						DEBUG(PSTR(" LV:"));
+						if(modeLiveView != (event_value ? true : false)) notify.changed(WATCH_LIVEVIEW);
 						if(event_value) modeLiveView = true; else modeLiveView = false;
 						#ifdef EXTENDED_DEBUG
 						if(modeLiveView) {DEBUG(PSTR("ON"));} else {DEBUG(PSTR("OFF"));}
@@ -1352,6 +1478,7 @@ uint8_t PTP::checkEvent()
 						break;
 					case EOS_DPC_Video:
 						DEBUG(PSTR(" VIDEO:"));
+						if(recording != (event_value == 4)) notify.changed(WATCH_VIDEO);
 						if(event_value == 4) recording = true; else recording = false;
 						#ifdef EXTENDED_DEBUG
 						if(recording) {DEBUG(PSTR("Recording"));} else {DEBUG(PSTR("OFF"));}
@@ -1476,6 +1603,7 @@ uint8_t PTP::checkEvent()
 			else if(event_type == EOS_EC_OBJECT_CREATED)
 			{
 				busy = false;
+				eventSeen = true;
 
 				//for(uint8_t x = 0; x < event_size / sizeof(uint32_t); x++)
 				//{
@@ -1663,6 +1791,7 @@ uint8_t PTP::videoStop()
 	if(PTP_protocol == PROTOCOL_EOS && recording)
 	{
 		recording  = false;
+		notify.changed(WATCH_VIDEO);
 		setEosParameter(EOS_DPC_Video, 0x00);
 	}
 	return 0;
@@ -1803,6 +1932,7 @@ uint8_t PTP::bulbEnd()
 		if(PTP_Transaction(NIKON_OC_BULBEND, 0, 2, data, 0, NULL)) return PTP_RETURN_ERROR; // Bulb End
 	}
 	bulb_open = false;
+	pollExpedite = true; // the image will be ready soon -- check right away
 	if(PTP_Response_Code != PTP_RESPONSE_OK) return PTP_RETURN_ERROR;
 	return 0;
 }
@@ -10,6 +10,11 @@
 // how many seconds before the busy flag is automatically cleared (to avoid stalls)
 #define BUSY_TIMEOUT_SECONDS 5
 
+// adaptive event polling intervals (milliseconds)
+#define PTP_POLL_MIN_MS 20   // right after an event or when one is due
+#define PTP_POLL_BUSY_MS 50  // while the camera is busy with no known completion time
+#define PTP_POLL_MAX_MS 800  // backoff ceiling while idle
+
 struct propertyDescription_t
 {
     char name[8];
@@ -71,6 +76,8 @@ public:
 
     uint8_t init(void);
     uint8_t checkEvent(void);
+    uint8_t pollTask(void);
+    void expectEvent(uint32_t inMs);
     uint8_t close(void);
     void resetConnection(void);
     uint8_t capture(void);
@@ -150,11 +157,20 @@ public:
 
     uint16_t photosRemaining;
 
+    volatile uint8_t pollExpedite;
+    uint16_t pollInterval, pollRate, noticeLatency, noticeLatencyMax;
+
     CameraSupports_t supports;
 
 private:
     uint32_t data[3];
 
+    uint8_t eventSeen, eventRead;
+    uint16_t pollCount;
+    uint32_t nextPoll, lastPoll, lastCheck, expectAt, pollRateStart;
+
+    uint8_t pipeEvent(void);
+
     static uint8_t isoEv(uint32_t id);
     static uint8_t shutterEv(uint32_t id);
     static uint8_t apertureEv(uint32_t id);
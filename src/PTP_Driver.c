@@ -35,6 +35,7 @@
  */
 
 #include "PTP_Driver.h"
+#include "notify.h"
 
 /** LUFA Still Image Class driver interface configuration and state information. This structure is
  *  passed to all Still Image Class driver functions, so that multiple instances of the same class
@@ -87,26 +88,46 @@ volatile uint8_t PTP_Ready, PTP_Connected, configured, PTP_Run_Task = 1, PTP_Ign
 volatile uint16_t PTP_Error, PTP_Response_Code;
 uint16_t supportedOperationsCount;
 uint16_t *supportedOperations;
+#ifdef PTP_STATS_ENABLED
+PTP_OpStats_t PTP_Stats[PTP_STATS_SLOTS];
+#endif
+
+static uint16_t statsOpCode, statsBytesOut;
+static uint32_t statsMs;
+
+static uint8_t PTP_RunTransaction(uint16_t opCode, uint8_t receive_data, uint8_t paramCount, uint32_t *params, uint8_t dataBytes, uint8_t *data);
+static uint8_t PTP_RunFetchData(uint16_t offset);
 
 /** Task to print device information through the serial port, and open/close a test PIMA session with the
  *  attached Still Image device.
  */
+
+/** Sets PTP_Ready, letting Notify know when it changes. */
+static void PTP_SetReady(uint8_t ready)
+{
+    if(PTP_Ready != ready)
+    {
+        PTP_Ready = ready;
+        NOTIFY_CHANGED(WATCH_CAMERA);
+    }
+}
+
 void PTP_Task(void)
 {
-//    USB_USBTask();
+    if(PTP_Run_Task) USB_USBTask(); // moved here from the tick ISR
     if(USB_HostState == HOST_STATE_Configured)
     {
         if(configured != USB_HostState)
         {
             configured = USB_HostState;
             PTP_OpenSession();
-            if(PTP_GetDeviceInfo() == 0) PTP_Ready = 1;
+            if(PTP_GetDeviceInfo() == 0) PTP_SetReady(1);
         }
     }
     else
     {
         configured = USB_HostState;
-        PTP_Ready = 0;
+        PTP_SetReady(0);
     }
 }
 
@@ -124,7 +145,7 @@ void PTP_Enable(void)
     puts_P(PSTR("Camera Enabled.\r\n"));
     #endif
     PTP_Bytes_Remaining = 0;
-    PTP_Ready = 0;
+    PTP_SetReady(0);
     PTP_Error = 0;
     PTP_Run_Task = 1;
 }
@@ -139,7 +160,7 @@ void PTP_Disable(void)
     puts_P(PSTR("Camera Disabled.\r\n"));
     #endif
     configured = 0;
-    PTP_Ready = 0;
+    PTP_SetReady(0);
     PTP_Connected = 0;
     PTP_Bytes_Remaining = 0;
     PTP_Run_Task = 1;
@@ -148,11 +169,68 @@ void PTP_Disable(void)
 }
 
 
+/** Per-opcode transaction statistics. The last slot collects any opcodes that
+ *  don't fit in the table. Latency is the time spent in the driver only, summed
+ *  over all the packets of a transaction, so parsing between PTP_FetchData calls
+ *  isn't counted.
+ */
+static void PTP_StatsRecord(uint16_t opCode, uint32_t ms, uint32_t bytesIn, uint32_t bytesOut, uint8_t error)
+{
+#ifdef PTP_STATS_ENABLED
+    uint8_t i, bucket;
+    PTP_OpStats_t *s = &PTP_Stats[PTP_STATS_SLOTS - 1];
+
+    for(i = 0; i < PTP_STATS_SLOTS - 1; i++)
+    {
+        if(PTP_Stats[i].opCode == 0) PTP_Stats[i].opCode = opCode;
+        if(PTP_Stats[i].opCode == opCode)
+        {
+            s = &PTP_Stats[i];
+            break;
+        }
+    }
+    if(s->opCode != opCode) s->opCode = PTP_STATS_OTHER;
+
+    s->count++;
+    if(error) s->errors++;
+    s->bytesIn += bytesIn;
+    s->bytesOut += bytesOut;
+    if(ms > 0xFFFF) ms = 0xFFFF;
+    if(ms > s->maxMs) s->maxMs = (uint16_t)ms;
+
+    for(bucket = 0; ms > 0 && bucket < PTP_STATS_BUCKETS - 1; bucket++) ms >>= 1;
+    s->histogram[bucket]++;
+#endif
+}
+
+void PTP_StatsReset(void)
+{
+#ifdef PTP_STATS_ENABLED
+    memset(PTP_Stats, 0, sizeof(PTP_Stats));
+#endif
+}
+
 uint8_t PTP_Transaction(uint16_t opCode, uint8_t receive_data, uint8_t paramCount, uint32_t *params, uint8_t dataBytes, uint8_t *data)
 {
+    uint8_t ret;
+
     if(PTP_Error) return PTP_RETURN_ERROR;
     if(PTP_Bytes_Remaining > 0) return PTP_FetchData(0);
 
+    statsOpCode = opCode;
+    statsBytesOut = (uint16_t)paramCount * sizeof(uint32_t) + dataBytes;
+    statsMs = PTP_Clock();
+
+    ret = PTP_RunTransaction(opCode, receive_data, paramCount, params, dataBytes, data);
+
+    statsMs = PTP_Clock() - statsMs;
+    if(ret != PTP_RETURN_DATA_REMAINING) PTP_StatsRecord(opCode, statsMs, receive_data ? PTP_Bytes_Total : 0, statsBytesOut, ret == PTP_RETURN_ERROR);
+
+    return ret;
+}
+
+static uint8_t PTP_RunTransaction(uint16_t opCode, uint8_t receive_data, uint8_t paramCount, uint32_t *params, uint8_t dataBytes, uint8_t *data)
+{
     uint8_t err;
 
     PTP_Run_Task = 0; // Pause task while we're busy with the transaction
@@ -239,7 +317,7 @@ uint8_t PTP_Transaction(uint16_t opCode, uint8_t receive_data, uint8_t paramCoun
         #endif
         if(PTP_Response_Code == PTP_RESPONSE_OK) PTP_Response_Code = err;
         PTP_Error = opCode;
-        PTP_Ready = 0;
+        PTP_SetReady(0);
         //USB_Host_SetDeviceConfiguration(0);
         PTP_Run_Task = 1;
         return PTP_RETURN_ERROR;
@@ -249,6 +327,19 @@ uint8_t PTP_Transaction(uint16_t opCode, uint8_t receive_data, uint8_t paramCoun
 }
 
 uint8_t PTP_FetchData(uint16_t offset)
+{
+    uint8_t ret;
+    uint32_t start = PTP_Clock();
+
+    ret = PTP_RunFetchData(offset);
+
+    statsMs += PTP_Clock() - start;
+    if(ret != PTP_RETURN_DATA_REMAINING) PTP_StatsRecord(statsOpCode, statsMs, PTP_Bytes_Total, statsBytesOut, ret == PTP_RETURN_ERROR);
+
+    return ret;
+}
+
+static uint8_t PTP_RunFetchData(uint16_t offset)
 {
     if(PTP_Bytes_Remaining > 0)
     {
@@ -312,6 +403,32 @@ uint16_t PTP_GetEvent(uint32_t *event_value)
 
 }
 
+/** Checks the events (interrupt) pipe without consuming anything, so the caller only needs
+ *  to run a transaction when the camera has something to say. Leaves an IN request armed
+ *  so the host controller keeps polling the endpoint in hardware between calls.
+ */
+uint8_t PTP_EventPending(void)
+{
+    uint8_t pending, prevPipe;
+
+    if ((USB_HostState != HOST_STATE_Configured) || !(DigitalCamera_SI_Interface.State.IsActive))
+      return 0;
+
+    prevPipe = Pipe_GetCurrentPipe();
+    Pipe_SelectPipe(DigitalCamera_SI_Interface.Config.EventsPipe.Address);
+
+    pending = Pipe_IsINReceived();
+    if (!pending && Pipe_IsFrozen())
+    {
+        Pipe_SetFiniteINRequests(1);
+        Pipe_Unfreeze();
+    }
+
+    Pipe_SelectPipe(prevPipe);
+
+    return pending;
+}
+
 uint8_t SI_Host_ReceiveEventHeaderTLP(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo,
                                    PIMA_Container_t* const PIMAHeader)
 {
@@ -50,6 +50,11 @@
 #define NO_RECEIVE_DATA 0
 #define RECEIVE_DATA 1
 
+#define PTP_STATS_ENABLED // per-opcode transaction stats (REMOTE_PTP_STATS, 'o'), 36 bytes of RAM a slot
+#define PTP_STATS_SLOTS 8
+#define PTP_STATS_BUCKETS 10 // log2 latency buckets in ms: 0, 1, 2-3, 4-7 ... 256+
+#define PTP_STATS_OTHER 0xFFFF
+
 
 /* Includes: */
 #include <avr/io.h>
@@ -69,6 +74,17 @@ extern "C"
 {
 #endif
 
+typedef struct
+{
+    uint16_t opCode;
+    uint16_t count;
+    uint16_t errors;
+    uint32_t bytesIn;
+    uint32_t bytesOut;
+    uint16_t maxMs;
+    uint16_t histogram[PTP_STATS_BUCKETS];
+} PTP_OpStats_t;
+
 /* Function Prototypes: */
 void PTP_Enable(void);
 void PTP_Disable(void);
@@ -81,8 +97,11 @@ void EVENT_USB_Host_DeviceEnumerationFailed(const uint8_t ErrorCode,
                                             const uint8_t SubErrorCode);
 void EVENT_USB_Host_DeviceEnumerationComplete(void);
 uint16_t PTP_GetEvent(uint32_t *event_value);
+uint8_t PTP_EventPending(void);
 uint8_t PTP_Transaction(uint16_t opCode, uint8_t receive_data, uint8_t paramCount, uint32_t *params, uint8_t dataBytes, uint8_t *data);
 uint8_t PTP_FetchData(uint16_t offset);
+void PTP_StatsReset(void);
+uint32_t PTP_Clock(void);
 uint8_t SI_Host_ReceiveResponseCode(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, PIMA_Container_t *PIMABlock);
 uint8_t SI_Host_ReceiveEventHeaderTLP(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, PIMA_Container_t* const PIMAHeader);
 uint8_t PTP_OpenSession(void);
@@ -101,6 +120,9 @@ extern volatile uint8_t PTP_Ready, PTP_Connected, PTP_Run_Task, PTP_IgnoreErrors
 extern volatile uint16_t PTP_Error, PTP_Response_Code;
 extern uint16_t supportedOperationsCount;
 extern uint16_t *supportedOperations; // note that this memory space is reused -- only available immediately after init
+#ifdef PTP_STATS_ENABLED
+extern PTP_OpStats_t PTP_Stats[PTP_STATS_SLOTS];
+#endif
 
 
 #ifdef __cplusplus
@@ -125,6 +125,25 @@ void VirtualSerial_PutChar(char c)
     fputc(c, &USBSerialStream);
 }
 
+/** Sends a byte without waiting on the host: 1 if it went into the endpoint, 0 if the host
+ *  hasn't taken the last packet yet, -1 if no terminal has the port open (DTR low).
+ */
+int8_t VirtualSerial_TryPutChar(char c)
+{
+    if((USB_DeviceState != DEVICE_STATE_Configured) ||
+       !(VirtualSerial_CDC_Interface.State.ControlLineStates.HostToDevice & CDC_CONTROL_LINE_OUT_DTR))
+      return -1;
+
+    Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address);
+
+    if(!Endpoint_IsReadWriteAllowed()) return 0;
+
+    Endpoint_Write_8(c);
+    if(!Endpoint_IsReadWriteAllowed()) Endpoint_ClearIN(); // packet full, send it
+
+    return 1;
+}
+
 void VirtualSerial_Reset(void)
 {
     USB_Detach();
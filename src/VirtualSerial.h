@@ -28,6 +28,7 @@ void EVENT_USB_Device_ControlRequest(void);
 void VirtualSerial_Reset(void);
 void VirtualSerial_Task(void);
 void VirtualSerial_PutChar(char c);
+int8_t VirtualSerial_TryPutChar(char c);
 char VirtualSerial_CharWaiting(void);
 char VirtualSerial_GetChar(void);
 void VirtualSerial_PutString(char *s);
@@ -0,0 +1,256 @@
+/*
+ *  adc.cpp
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <LUFA/Common/Common.h>
+#include <LUFA/Drivers/Peripheral/ADC.h>
+#include "clock.h"
+#include "adc.h"
+
+extern Clock clock;
+
+static adc_channel_t channels[ADC_CHANNELS];
+static uint8_t channelCount;
+
+static volatile uint8_t state;
+static volatile int8_t active;   // slot being read, -1 for adc_readNow
+static volatile int16_t samples; // conversions still to take, the first is thrown away
+static volatile uint32_t sum;
+static volatile uint16_t result; // adc_readNow average
+static uint32_t settleAt;
+
+/******************************************************************
+ *
+ *   adc_channel
+ *   Adds a channel to be read in the background.  Returns the slot
+ *   for adc_read, or -1 if all are in use.
+ *
+ ******************************************************************/
+
+int8_t adc_channel(uint8_t mux, uint16_t period, uint8_t oversample, uint8_t filter, uint8_t settle, void (*power)(uint8_t))
+{
+    if(channelCount >= ADC_CHANNELS) return -1;
+
+    adc_channel_t *c = &channels[channelCount];
+
+    c->mux = mux;
+    c->period = period;
+    c->oversample = oversample;
+    c->filter = filter;
+    c->settle = settle;
+    c->power = power;
+    c->due = clock.Ms();
+    c->value = 0;
+    c->readings = 0;
+
+    return (int8_t)channelCount++;
+}
+
+/******************************************************************
+ *
+ *   adc_valid
+ *
+ *
+ ******************************************************************/
+
+uint8_t adc_valid(int8_t slot)
+{
+    return slot >= 0 && channels[slot].readings > 0;
+}
+
+/******************************************************************
+ *
+ *   adc_read
+ *   Last filtered reading (10 bit), rounded
+ *
+ ******************************************************************/
+
+uint16_t adc_read(int8_t slot)
+{
+    uint16_t v;
+    uint8_t sreg = SREG;
+
+    cli();
+    v = channels[slot].value;
+    SREG = sreg;
+
+    return (v + (1 << (ADC_FRACTION - 1))) >> ADC_FRACTION;
+}
+
+/******************************************************************
+ *
+ *   adc_start
+ *   Starts a burst of conversions, ADC_vect counts them down
+ *
+ ******************************************************************/
+
+static void adc_start(uint8_t mux, uint8_t oversample)
+{
+    uint16_t m;
+    uint8_t sreg = SREG;
+
+    if(mux < 15)
+        ADC_SetupChannel(mux);
+
+    if(mux > 7)
+        m = (1 << 8 | ((mux - 8) << MUX0));
+    else
+        m = mux << MUX0;
+
+    cli();
+    sum = 0;
+    samples = (1 << oversample) + 1;
+    state = ADC_CONVERTING;
+    ADC_Init(ADC_FREE_RUNNING | ADC_PRESCALE_32);
+    ADCSRA |= (1 << ADIE);
+    ADC_StartReading(ADC_REFERENCE_AVCC | ADC_RIGHT_ADJUSTED | m);
+    SREG = sreg;
+}
+
+/******************************************************************
+ *
+ *   adc_complete
+ *   ADC conversion complete interrupt
+ *
+ ******************************************************************/
+
+volatile void adc_complete()
+{
+    uint16_t r = ADC_GetResult();
+
+    if(samples-- > (int16_t)(1 << (active < 0 ? ADC_ONESHOT_OVERSAMPLE : channels[active].oversample)))
+        return; // first conversion after switching the input
+
+    sum += r;
+    if(samples > 0) return;
+
+    ADC_Disable(); // off between bursts to save power
+
+    if(active < 0)
+    {
+        result = (uint16_t)(sum >> ADC_ONESHOT_OVERSAMPLE);
+    }
+    else
+    {
+        adc_channel_t *c = &channels[active];
+        uint16_t v = (uint16_t)((sum << ADC_FRACTION) >> c->oversample);
+
+        if(c->power) c->power(0);
+
+        if(c->readings == 0 || c->filter == 0)
+            c->value = v;
+        else
+            c->value = (uint16_t)((int32_t)c->value + (((int32_t)v - (int32_t)c->value) >> c->filter));
+        if(c->readings < 0xFFFF) c->readings++;
+    }
+
+    state = ADC_IDLE;
+}
+
+/******************************************************************
+ *
+ *   adc_task
+ *   Main loop -- starts the next due reading, powering its sensor
+ *   and waiting out the settle time first if it has one
+ *
+ ******************************************************************/
+
+void adc_task()
+{
+    uint32_t now = clock.Ms();
+
+    if(state == ADC_SETTLING)
+    {
+        if(now < settleAt)
+        {
+            clock.wakeAt(settleAt);
+            return;
+        }
+        adc_start(channels[active].mux, channels[active].oversample);
+    }
+    if(state != ADC_IDLE) return;
+
+    for(uint8_t i = 0; i < channelCount; i++)
+    {
+        adc_channel_t *c = &channels[i];
+
+        if(now >= c->due)
+        {
+            c->due = now + c->period;
+            active = i;
+            if(c->power) c->power(1);
+            if(c->settle)
+            {
+                state = ADC_SETTLING;
+                settleAt = now + c->settle;
+                clock.wakeAt(settleAt);
+            }
+            else
+            {
+                adc_start(c->mux, c->oversample);
+            }
+            return;
+        }
+        clock.wakeAt(c->due);
+    }
+}
+
+/******************************************************************
+ *
+ *   adc_readNow
+ *   Reads an input straight away, for callers that need it now
+ *   (light sensor ranges).  Waits for a background reading to
+ *   finish first, idling the CPU while the conversions run.
+ *   With a power function, the sensor is switched on after that
+ *   reading (which may switch it off as it ends), given 'settle'
+ *   ms, and only switched off again once the conversions are done.
+ *
+ ******************************************************************/
+
+uint16_t adc_readNow(uint8_t mux, void (*power)(uint8_t), uint8_t settle)
+{
+    cli();
+    while(state == ADC_CONVERTING)
+    {
+        clock.nap(1);
+        cli();
+    }
+    sei();
+
+    uint8_t was = state; // a settling channel is restarted afterwards
+    int8_t wasActive = active;
+
+    if(power)
+    {
+        power(1);
+        while(settle--) _delay_ms(1);
+    }
+
+    active = -1;
+    adc_start(mux, ADC_ONESHOT_OVERSAMPLE);
+
+    cli();
+    while(state == ADC_CONVERTING)
+    {
+        clock.nap(1);
+        cli();
+    }
+    sei();
+
+    // leave it on if a background reading of the same sensor is settling //
+    if(power && !(was == ADC_SETTLING && channels[wasActive].power == power)) power(0);
+
+    active = wasActive;
+    state = was;
+
+    return result;
+}
@@ -0,0 +1,39 @@
+/*
+ *  adc.h
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+// Interrupt-driven ADC: each channel is read every 'period' ms as a burst of //
+// 2^oversample conversions, then low-pass filtered.  Readers get the last value. //
+#define ADC_CHANNELS 4
+#define ADC_FRACTION 6          // filtered values carry 6 bits below the 10 bit reading
+#define ADC_ONESHOT_OVERSAMPLE 6 // 64 conversions for adc_readNow
+
+#define ADC_IDLE 0
+#define ADC_SETTLING 1
+#define ADC_CONVERTING 2
+
+struct adc_channel_t
+{
+    uint8_t mux;        // ADC input 0-13
+    uint8_t oversample; // log2 of the conversions per reading
+    uint8_t filter;     // IIR shift, 0 to keep just the last reading
+    uint8_t settle;     // ms after power(1) before converting
+    uint16_t period;    // ms between readings
+    void (*power)(uint8_t on); // optional, switches the sensor for the reading
+    uint32_t due;       // Ms() of the next reading
+    uint16_t value;     // filtered, << ADC_FRACTION
+    uint16_t readings;  // completed so far, 0 = value not valid yet
+};
+
+int8_t adc_channel(uint8_t mux, uint16_t period, uint8_t oversample, uint8_t filter, uint8_t settle, void (*power)(uint8_t));
+uint8_t adc_valid(int8_t slot);
+uint16_t adc_read(int8_t slot);
+uint16_t adc_readNow(uint8_t mux, void (*power)(uint8_t) = 0, uint8_t settle = 0);
+void adc_task(void);
+volatile void adc_complete(void);
@@ -13,13 +13,18 @@
 #include <stdlib.h>
 #include <util/delay.h>
 #include <avr/wdt.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+#include <string.h>
 #include "tldefs.h"
 #include "hardware.h"
 #include "bluetooth.h"
+#include "clock.h"
 #include "debug.h"
 #include "settings.h"
 
 extern settings_t conf;
+extern Clock clock;
 
 /******************************************************************
  *
@@ -46,6 +51,7 @@ uint8_t BT::init(void)
 {
 	_delay_ms(100);
 	present = true;
+	setFraming(BT_FRAMING_V1);
 //	DEBUG(PSTR("BT Init\n\r"));
 
 //	sendCMD(PSTR("ATRST\r")); // Reset module
@@ -583,6 +589,9 @@ uint8_t BT::sendDATA(uint8_t id, uint8_t type, void* buffer, uint16_t bytes)
 	if(!present)
 		return 1;
 
+	if(framing == BT_FRAMING_V2)
+		return sendFrames(id, type, (char *) buffer, bytes);
+
 //	DEBUG(PSTR("Sending: "));
 //	DEBUG(id);
 //	DEBUG(PSTR(", "));
@@ -635,6 +644,291 @@ uint8_t BT::sendDATA(uint8_t id, uint8_t type, void* buffer, uint16_t bytes)
 	return 0;
 }
 
+/******************************************************************
+ *
+ *   BT::setFraming
+ *   Switches between BT_FRAMING_V1 and _V2 (negotiated through
+ *   REMOTE_PROTOCOL_VERSION), starting the sequence numbers over
+ *
+ ******************************************************************/
+
+void BT::setFraming(uint8_t f)
+{
+	framing = f;
+	txSeq = 0;
+	txAcked = 0;
+	txSync = 1;
+	rxSeq = 0;
+	rxLen = 0;
+	rxDrop = 0;
+	timeouts = 0;
+	for(uint8_t i = 0; i < BT_V2_WINDOW; i++) txWindow[i].len = 0;
+}
+
+void BT::resetStats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+static uint16_t frameCRC(char *frame, uint8_t len)
+{
+	uint16_t crc = 0xFFFF;
+	for(uint8_t i = 1; i < BT_V2_HEADER + len; i++) crc = _crc_ccitt_update(crc, frame[i]);
+	return crc;
+}
+
+/******************************************************************
+ *
+ *   BT::sendFrames
+ *   Sends a message as v2 frames of up to BT_V2_PAYLOAD bytes:
+ *
+ *   '#', seq, ack, sack, id, type, len, data, CRC-16 (CCITT, LSB
+ *   first, over seq to the end of data)
+ *
+ *   ack is the next seq expected from the other side and sack has
+ *   bit n set if it has frame ack + 1 + n already.  Up to
+ *   BT_V2_WINDOW frames go out before waiting for acknowledgements;
+ *   each is kept until acknowledged, and sent again (unless sacked)
+ *   after BT_V2_RTO_MS.  Frames with id 0 only acknowledge and don't
+ *   take a seq.  The T+ itself takes frames in order only and never
+ *   sets sack; messages to it can be split the same way, up to
+ *   BT_V2_MESSAGE bytes.
+ *
+ ******************************************************************/
+
+uint8_t BT::sendFrames(uint8_t id, uint8_t type, char *buffer, uint16_t bytes)
+{
+	if(!dataMode()) return 0;
+
+	do
+	{
+		uint8_t len = bytes > BT_V2_PAYLOAD ? BT_V2_PAYLOAD : bytes;
+
+		if(!windowWait()) return 0;
+
+		bt_frame *f = &txWindow[txSeq % BT_V2_WINDOW];
+		char *frame = f->frame;
+
+		frame[0] = '#';
+		frame[1] = txSeq;
+		frame[2] = rxSeq;
+		frame[3] = 0;
+		frame[4] = id;
+		frame[5] = type | (bytes > len ? BT_V2_MORE : 0) | (txSync ? BT_V2_SYNC : 0);
+		frame[6] = len;
+		memcpy(&frame[BT_V2_HEADER], buffer, len);
+		uint16_t crc = frameCRC(frame, len);
+		frame[BT_V2_HEADER + len] = (char)(crc & 0xff);
+		frame[BT_V2_HEADER + len + 1] = (char)(crc >> 8);
+
+		f->len = BT_V2_OVERHEAD + len;
+		f->sacked = 0;
+		f->sentMs = clock.Ms();
+		txSeq++;
+		txSync = 0;
+		stats.framesOut++;
+		stats.bytesOut += len;
+
+		sendRaw(frame, f->len);
+
+		buffer += len;
+		bytes -= len;
+	} while(bytes > 0);
+
+	return 1;
+}
+
+uint8_t BT::sendRaw(char *buffer, uint8_t bytes)
+{
+	while(bytes--)
+	{
+		if(waitRTS()) return 0;
+		Serial_SendByte(*buffer++);
+		wdt_reset();
+	}
+	return 1;
+}
+
+void BT::sendAck(void)
+{
+	char frame[BT_V2_OVERHEAD];
+
+	frame[0] = '#';
+	frame[1] = txSeq;
+	frame[2] = rxSeq;
+	frame[3] = 0;
+	frame[4] = 0;
+	frame[5] = 0;
+	frame[6] = 0;
+	uint16_t crc = frameCRC(frame, 0);
+	frame[7] = (char)(crc & 0xff);
+	frame[8] = (char)(crc >> 8);
+
+	sendRaw(frame, BT_V2_OVERHEAD);
+}
+
+/******************************************************************
+ *
+ *   BT::windowWait
+ *   Reads acknowledgements until there's room in the window; 0 if
+ *   the link went away meanwhile.  Data frames that come in are left
+ *   unacknowledged, to be sent again, since buf is reused.
+ *
+ ******************************************************************/
+
+uint8_t BT::windowWait(void)
+{
+	if((uint8_t)(txSeq - txAcked) < BT_V2_WINDOW) return 1;
+
+	uint32_t start = clock.Ms();
+	uint8_t id = dataId, type = dataType, e = event;
+	uint16_t size = dataSize;
+	char *d = data;
+
+	holdData = 1;
+	while((uint8_t)(txSeq - txAcked) >= BT_V2_WINDOW && framing == BT_FRAMING_V2 && state == BT_ST_CONNECTED)
+	{
+		wdt_reset();
+		task();
+		retransmit();
+	}
+	holdData = 0;
+
+	dataId = id;
+	dataType = type;
+	dataSize = size;
+	data = d;
+	event = e;
+	stats.waitMs += clock.Ms() - start;
+
+	return framing == BT_FRAMING_V2 && state == BT_ST_CONNECTED;
+}
+
+/******************************************************************
+ *
+ *   BT::retransmit
+ *   Sends again the unacknowledged frames once the oldest is
+ *   BT_V2_RTO_MS old; after BT_V2_RETRIES of those in a row gives
+ *   them up and restarts the sequence with the next frame
+ *
+ ******************************************************************/
+
+void BT::retransmit(void)
+{
+	if(txAcked == txSeq) return;
+	if(clock.Ms() - txWindow[txAcked % BT_V2_WINDOW].sentMs < BT_V2_RTO_MS) return;
+
+	if(++timeouts > BT_V2_RETRIES)
+	{
+		for(uint8_t i = 0; i < BT_V2_WINDOW; i++) txWindow[i].len = 0;
+		txAcked = txSeq;
+		txSync = 1;
+		timeouts = 0;
+		stats.stalls++;
+		return;
+	}
+
+	for(uint8_t s = txAcked; s != txSeq; s++)
+	{
+		bt_frame *f = &txWindow[s % BT_V2_WINDOW];
+		if(f->sacked || !f->len) continue;
+		f->sentMs = clock.Ms();
+		stats.retransmits++;
+		sendRaw(f->frame, f->len);
+	}
+}
+
+void BT::acked(uint8_t ack, uint8_t sack)
+{
+	if((uint8_t)(ack - txAcked) > (uint8_t)(txSeq - txAcked)) return; // old or bogus
+
+	while(txAcked != ack)
+	{
+		txWindow[txAcked % BT_V2_WINDOW].len = 0;
+		txAcked++;
+		timeouts = 0;
+	}
+
+	for(uint8_t i = 0; i < BT_V2_WINDOW; i++)
+	{
+		uint8_t s = ack + 1 + i;
+		if((sack & (1 << i)) && (uint8_t)(s - txAcked) < (uint8_t)(txSeq - txAcked)) txWindow[s % BT_V2_WINDOW].sacked = 1;
+	}
+}
+
+/******************************************************************
+ *
+ *   BT::frameIn
+ *   Checks a v2 frame read into buf and takes its acknowledgement;
+ *   BT_EVENT_DATA once the next message in sequence is complete.  A
+ *   message split over BT_V2_MORE frames is put back together in
+ *   rxMsg, a single frame is left in buf.  A BT_V2_SYNC frame sent
+ *   again because its ack was lost is only acknowledged again.
+ *
+ ******************************************************************/
+
+uint8_t BT::frameIn(uint8_t len)
+{
+	uint8_t n = (uint8_t)buf[6];
+
+	if(len != BT_V2_OVERHEAD + n || frameCRC(buf, n) != ((uint8_t)buf[BT_V2_HEADER + n] | ((uint16_t)(uint8_t)buf[BT_V2_HEADER + n + 1] << 8)))
+	{
+		stats.crcErrors++;
+		return BT_EVENT_NULL;
+	}
+
+	acked((uint8_t)buf[2], (uint8_t)buf[3]);
+	if(buf[4] == 0) return BT_EVENT_NULL; // acknowledgement only
+
+	if((buf[5] & BT_V2_SYNC) && (uint8_t)(rxSeq - (uint8_t)buf[1] - 1) >= BT_V2_WINDOW) // not one of the last frames taken
+	{
+		rxSeq = (uint8_t)buf[1];
+		rxLen = 0; // the rest of a split message isn't coming
+		rxDrop = 0;
+	}
+	if((uint8_t)buf[1] != rxSeq || holdData)
+	{
+		if((uint8_t)buf[1] != rxSeq) stats.seqErrors++;
+		sendAck(); // tells the other side what's missing
+		return BT_EVENT_NULL;
+	}
+
+	rxSeq++;
+	stats.framesIn++;
+	stats.bytesIn += n;
+	sendAck();
+
+	if(rxLen || (buf[5] & BT_V2_MORE))
+	{
+		if(rxLen + n > BT_V2_MESSAGE) rxDrop = 1;
+		if(!rxDrop)
+		{
+			memcpy(rxMsg + rxLen, buf + BT_V2_HEADER, n);
+			rxLen += n;
+		}
+		if(buf[5] & BT_V2_MORE) return BT_EVENT_NULL;
+
+		data = rxMsg;
+		dataSize = rxLen;
+		rxLen = 0;
+		if(rxDrop)
+		{
+			rxDrop = 0;
+			return BT_EVENT_NULL;
+		}
+	}
+	else
+	{
+		data = buf + BT_V2_HEADER;
+		dataSize = n;
+	}
+
+	dataId = buf[4];
+	dataType = buf[5] & ~(BT_V2_MORE | BT_V2_SYNC);
+
+	return BT_EVENT_DATA;
+}
+
 
 
 /******************************************************************
@@ -827,12 +1121,33 @@ uint8_t BT::read(void)
 	{
 		timeout = 0;
 
-		while(!Serial_IsCharReceived())
+		if(bytes == 0 && clock.idleOk)
 		{
-			wdt_reset();
-			_delay_us(10);
-			if(++timeout > (bytes > 0 ? 50000 : 5000))
-				break;
+			// Nothing has started yet -- sleep until the first byte or the timeout instead of spinning
+			uint32_t start = clock.Ms();
+			for(;;)
+			{
+				wdt_reset();
+				cli();
+				UCSR1B |= (1 << RXCIE1); // wake on RX
+				if(Serial_IsCharReceived() || clock.Ms() - start >= BT_IDLE_WAIT_MS)
+					break;
+				clock.nap(BT_IDLE_WAIT_MS - (uint16_t)(clock.Ms() - start));
+			}
+			UCSR1B &= ~(1 << RXCIE1);
+			sei();
+			if(!Serial_IsCharReceived())
+				timeout = 5001;
+		}
+		else
+		{
+			while(!Serial_IsCharReceived())
+			{
+				wdt_reset();
+				_delay_us(10);
+				if(++timeout > (bytes > 0 ? 50000 : 5000))
+					break;
+			}
 		}
 
 		if(timeout > 50000)
@@ -872,6 +1187,22 @@ uint8_t BT::read(void)
 			if(bytes > 0 && buf[bytes - 1] == '\n') // just get one line at a time
 				break;
 		}
+		else if(framing == BT_FRAMING_V2)
+		{
+			if(buf[0] != '#' && bytes > 1 && buf[bytes - 1] == '#')
+			{
+				buf[0] = '#';
+				bytes = 1;
+			}
+			if(buf[0] == '#')
+			{
+				if(bytes >= BT_V2_HEADER && bytes >= BT_V2_OVERHEAD + (uint8_t)buf[6]) break;
+			}
+			else if(buf[bytes - 1] == '\n') // just get one line at a time
+			{
+				break;
+			}
+		}
 		else
 		{
 			if(buf[0] != '$' && bytes > 1 && buf[bytes - 1] == '$')
@@ -890,8 +1221,7 @@ uint8_t BT::read(void)
 					dataId = buf[1];
 					dataType = buf[2];
 
-					*(&dataSize) = buf[3];
-					*(&dataSize + 1) = buf[4];
+					dataSize = (uint8_t)buf[3] | ((uint16_t)(uint8_t)buf[4] << 8);
 
 					data = (buf + 6);
 
@@ -904,7 +1234,7 @@ uint8_t BT::read(void)
 			}
 		}
 
-		if(bytes >= BT_BUF_SIZE)
+		if(bytes >= BT_BUF_SIZE - 1) // leaves room for the terminator
 			break;
 	}
 
@@ -916,6 +1246,20 @@ uint8_t BT::read(void)
 }
 
 
+/******************************************************************
+ *
+ *   ISR
+ *
+ *   USART1 receive - only enabled to wake BT::read() from idle,
+ *   which reads the byte itself
+ *
+ ******************************************************************/
+
+ISR(USART1_RX_vect)
+{
+	UCSR1B &= ~(1 << RXCIE1);
+}
+
 /******************************************************************
  *
  *   BT::task
@@ -1009,6 +1353,7 @@ uint8_t BT::task(void)
 				ret = BT_EVENT_DISCONNECT;
 				mode = BT_MODE_CMD;
 				state = BT_ST_IDLE;
+				setFraming(BT_FRAMING_V1);
 			}
 			if(strncmp(buf, STR("DONE"), 4) == 0)
 			{
@@ -1035,6 +1380,11 @@ uint8_t BT::task(void)
 				ret = BT_EVENT_DISCONNECT;
 				mode = BT_MODE_CMD;
 				state = BT_ST_IDLE;
+				setFraming(BT_FRAMING_V1);
+			}
+			else if(framing == BT_FRAMING_V2)
+			{
+				if(buf[0] == '#') ret = frameIn(len);
 			}
 			else if(dataId > 0)
 			{
@@ -1047,6 +1397,20 @@ uint8_t BT::task(void)
 			}
 		}
 	}
+
+	if(framing == BT_FRAMING_V2 && !holdData) retransmit();
+
+	if(holdData && ret == BT_EVENT_DISCONNECT) // BT::windowWait is reading; pass it on afterwards
+	{
+		heldEvent = ret;
+		ret = BT_EVENT_NULL;
+	}
+	else if(!holdData && ret == BT_EVENT_NULL && heldEvent)
+	{
+		ret = heldEvent;
+		heldEvent = 0;
+	}
+
 	event = ret;
 	return ret;
 }
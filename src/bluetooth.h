@@ -11,6 +11,7 @@
 #define BT_NAME_LEN 13
 #define BT_BUF_SIZE 128
 #define BT_MAX_SCAN 5
+#define BT_IDLE_WAIT_MS 50 // how long read() waits for a message to start
 #define BT_ADDR_LEN 13
 #define BT_NAME_LEN 13
 
@@ -35,6 +36,18 @@
 #define BT_EVENT_DATA 4
 #define BT_EVENT_SCAN_COMPLETE 5
 
+#define BT_FRAMING_V1 1     // '$', id, type, size (2), ':', data
+#define BT_FRAMING_V2 2     // '#', seq, ack, sack, id, type, len, data, CRC-16 -- see BT::sendFrames
+#define BT_V2_HEADER 7
+#define BT_V2_OVERHEAD 9    // header and CRC
+#define BT_V2_PAYLOAD 64    // most data sent in one frame; longer sends are split, BT_V2_MORE on all but the last
+#define BT_V2_MORE 0x80     // in type: the message continues in the next frame
+#define BT_V2_MESSAGE 128   // longest message taken in over several frames (REMOTE_STORED SET is 1 + sizeof(program)); longer ones are dropped
+#define BT_V2_SYNC 0x40     // in type: sequence numbers restart at this frame
+#define BT_V2_WINDOW 4      // frames sent ahead of the acknowledgements (8 at most, the SACK bits)
+#define BT_V2_RTO_MS 300    // sends again what isn't acknowledged after this
+#define BT_V2_RETRIES 5     // timeouts in a row before the unacknowledged frames are dropped
+
 
 struct discovery
 {
@@ -42,6 +55,27 @@ struct discovery
     char addr[BT_ADDR_LEN + 1];
 };
 
+struct bt_frame
+{
+    uint8_t len;       // 0 once acknowledged
+    uint8_t sacked;    // acknowledged out of order, not to be sent again
+    uint32_t sentMs;
+    char frame[BT_V2_OVERHEAD + BT_V2_PAYLOAD];
+};
+
+struct bt_link_stats
+{
+    uint32_t bytesOut;     // payload
+    uint32_t bytesIn;
+    uint16_t framesOut;
+    uint16_t framesIn;
+    uint16_t retransmits;
+    uint16_t crcErrors;
+    uint16_t seqErrors;    // frames out of order or repeated, dropped
+    uint16_t stalls;       // times the window was dropped for lack of acknowledgements
+    uint32_t waitMs;       // spent waiting for room in the window
+};
+
 class BT
 {
 public:
@@ -55,6 +89,8 @@ public:
     uint8_t sendCMD(char *str);
     uint8_t sendCMD(const char *str);
     uint8_t sendDATA(uint8_t id, uint8_t type, void* buffer, uint16_t bytes);
+    void setFraming(uint8_t f);
+    void resetStats(void);
     uint8_t waitRTS(void);
     uint8_t power(uint8_t level);
     uint8_t power(void);
@@ -84,6 +120,9 @@ public:
     uint8_t dataType;
     uint16_t dataSize;
 
+    uint8_t framing;
+    bt_link_stats stats;
+
     discovery device[BT_MAX_SCAN];
     uint8_t devices;
 
@@ -96,4 +135,19 @@ private:
     uint8_t newDevices;
     uint8_t waitEventStatus;
     char *waitEventString;
+
+    uint8_t sendFrames(uint8_t id, uint8_t type, char *buffer, uint16_t bytes);
+    uint8_t sendRaw(char *buffer, uint8_t bytes);
+    uint8_t windowWait(void);
+    void retransmit(void);
+    void acked(uint8_t ack, uint8_t sack);
+    void sendAck(void);
+    uint8_t frameIn(uint8_t len);
+
+    uint8_t txSeq, txAcked, txSync, rxSeq;
+    char rxMsg[BT_V2_MESSAGE]; // the frames of a BT_V2_MORE message so far
+    uint8_t rxLen, rxDrop;
+    uint8_t timeouts;
+    uint8_t holdData, heldEvent;
+    bt_frame txWindow[BT_V2_WINDOW];
 };
@@ -18,11 +18,14 @@
 #include "hardware.h"
 #include "tldefs.h"
 #include "settings.h"
+#include "events.h"
 // The followinging are interrupt-driven keypad reading functions
 //  which includes DEBOUNCE ON/OFF mechanism, and continuous pressing detection
 
 extern Clock clock;
 extern MENU menu;
+extern LCD lcd;
+extern EventQueue events;
 
 const unsigned char PROGMEM button_pins[] = { 4, 2, 4, 5, 7, 6 };
 
@@ -46,7 +49,15 @@ Button::Button()
     // reset button arrays
     char p;
     
+    // FL is the only key on an external interrupt pin (INT4), so it's also caught on its edges //
+    EICRB = (EICRB & ~(1 << ISC41)) | (1 << ISC40); // any change
+    EIMSK |= (1 << INT4);
+
     verticalRepeat = 0;
+    sampled = 0;
+    keys = 0;
+    keysStamp = 0;
+    running = 0;
 
     for(uint8_t i = 0; i < NUM_KEYS; i++)
     {
@@ -70,27 +81,106 @@ Button::Button()
 
 /******************************************************************
  *
- *   Button:poll
+ *   Button::sample
+ *   Called from the tick, the FL edge interrupt and after a
+ *   power-down -- reads the keys and posts the mask when it
+ *   changes.  Debouncing is left to Button::task.
+ *
+ ******************************************************************/
+
+volatile void Button::sample()
+{
+    uint8_t fb = ~FB_PIN;
+    uint8_t b = ~B_PIN;
+    uint8_t k;
+
+    // same order as button_pins[] //
+    k  = (fb >> 4) & 1;
+    k |= ((fb >> 2) & 1) << 1;
+    k |= ((b >> 4) & 1) << 2;
+    k |= ((b >> 5) & 1) << 3;
+    k |= ((b >> 7) & 1) << 4;
+    k |= ((b >> 6) & 1) << 5;
+
+    // if the queue is full this is tried again next tick, so the change isn't lost //
+    if(k != sampled && events.post(EVENT_BUTTONS, k, clock.stamp())) sampled = k;
+}
+
+/******************************************************************
  *
+ *   Button::powerDown
+ *   INT4 edges need the I/O clock -- only a low level can wake the
+ *   CPU from power-down, so switch modes around it
  *
  ******************************************************************/
 
-volatile void Button::poll()
+void Button::powerDown(uint8_t on)
 {
-    uint8_t i;
-    char p;
+    if(on)
+    {
+        EICRB &= ~((1 << ISC41) | (1 << ISC40)); // low level
+    }
+    else
+    {
+        EICRB = (EICRB & ~(1 << ISC41)) | (1 << ISC40); // any change
+        EIFR = (1 << INTF4);
+    }
+}
+
+/******************************************************************
+ *
+ *   Button::task
+ *   Runs the debounce for each ms since the last call, using the
+ *   key changes posted by the tick.  Key events are the only kind
+ *   queued so far, so this is the queue's consumer.
+ *
+ ******************************************************************/
+
+void Button::task()
+{
+    event_t e;
+    int16_t n;
+
+    if(running) return; // step() can end up back here through menu.task()
+    running = 1;
+
+    for(;;)
+    {
+        uint16_t now = clock.stamp();
+        uint8_t got = events.get(&e);
+
+        if(got) now = e.stamp;
+
+        for(n = (int16_t)(now - keysStamp); n > 0; n--)
+        {
+            if(!step(keys)) break; // all keys up and settled -- nothing more to count
+        }
+        keysStamp = now;
+
+        if(!got) break;
+        if(e.type == EVENT_BUTTONS) keys = e.data;
+    }
+
+    running = 0;
+}
+
+/******************************************************************
+ *
+ *   Button::step
+ *   One ms of debounce and auto-repeat for the given key mask.
+ *   Returns 0 once all keys are up and settled.
+ *
+ ******************************************************************/
+
+uint8_t Button::step(uint8_t mask)
+{
+    uint8_t i, busy = 0;
 
     for(i = 0; i < NUM_KEYS; i++)
     {
-        p = pgm_read_byte(&button_pins[i]);
-        
-        if(i < 2) 
-            p = (getBit(p, FB_PIN) == LOW);
-        else 
-            p = (getBit(p, B_PIN) == LOW);
-        
-        if(p)  // key is pressed
+        if(mask & (1 << i))  // key is pressed
         {
+            busy = 1;
             if(button_count[i] < DEBOUNCE_REPEAT_DELAY)
             {
                 button_count[i]++;
@@ -119,8 +209,10 @@ volatile void Button::poll()
                     off_count++;
                     if(off_count > POWER_OFF_TIME)
                     {
+                        char p = pgm_read_byte(&button_pins[i]);
                         menu.message(TEXT("Power Off"));
                         menu.task();
+                        lcd.wait();
                         cli();
                         while(getBit(p, FB_PIN) == LOW) wdt_reset();
                         hardware_off();
@@ -134,6 +226,7 @@ volatile void Button::poll()
             if(i + 1 == FL_KEY) off_count = 0;
             if(button_count[i] > 0)
             {
+                busy = 1;
                 button_flag[i] = 0;
                 if(button_count[i] > DEBOUNCE_MAX) button_count[i] = DEBOUNCE_MAX;
                 button_count[i]--;
@@ -145,6 +238,27 @@ volatile void Button::poll()
             }
         }
     }
+
+    return busy;
+}
+
+/******************************************************************
+ *
+ *   Button::idle
+ *
+ *   true if no key is down, debouncing or waiting to be read
+ *
+ ******************************************************************/
+
+uint8_t Button::idle()
+{
+    if(sampled || keys || !events.empty()) return 0;
+
+    for(uint8_t i = 0; i < NUM_KEYS; i++)
+    {
+        if(button_count[i] || button_flag[i]) return 0;
+    }
+    return 1;
 }
 
 /******************************************************************
@@ -160,6 +274,8 @@ char Button::get()
     char key;
     uint8_t i;
 
+    task();
+
     if(clock.slept()) 
         flushBuffer();
 
@@ -193,6 +309,8 @@ char Button::pressed()
     char key;
     uint8_t i;
 
+    task();
+
     if(clock.slept()) 
         flushBuffer();
     
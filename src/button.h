@@ -30,11 +30,14 @@ class Button
 {
 public:
     Button();
-    volatile void poll();
+    volatile void sample();
+    void powerDown(uint8_t on);
+    void task();
     char get();
     char pressed();
     char waitfor(char key);
     void flushBuffer();
+    uint8_t idle();
 
     uint8_t verticalRepeat;
 
@@ -46,6 +49,12 @@ private:
     // button on flags for user program
     char button_flag[NUM_KEYS];
     uint16_t off_count;
+
+    uint8_t step(uint8_t mask);
+    uint8_t sampled;    // last key mask posted by the tick (ISR side)
+    uint8_t keys;       // key mask being debounced (main loop side)
+    uint16_t keysStamp; // Clock::stamp() the debounce has been run up to
+    uint8_t running;
 };
 
 
@@ -12,6 +12,8 @@
 #include <avr/sleep.h>
 #include <avr/interrupt.h>
 #include <avr/eeprom.h>
+#include <avr/wdt.h>
+#include <string.h>
 #include "clock.h"
 #include "button.h"
 #include "5110LCD.h"
@@ -36,6 +38,7 @@ extern Light light;
 
 Clock::Clock()
 {
+    memset(wheel, CLOCK_TIMER_NONE, sizeof(wheel));
 }
 
 /******************************************************************
@@ -47,22 +50,23 @@ Clock::Clock()
 
 void Clock::init()
 {
-    // Clear on OCR2A match //
-    TCCR2A = (1 << WGM21);
-    TCCR2B = 0;
-
-    TCCR2B |= (1 << CS22); // 64
-    OCR2A = 122; //125; // Match value (for interrupt)
-
-    // Normal clock source //
-    ASSR = (0 << AS2);
-
-    //Timer2 Compare Interrupt Enable
-    TIMSK2 = (1 << OCIE2A);
+    // Timer3 free-runs at 1/8 F_CPU //
+    // Compare B is the system tick, compare A times bulbs (only enabled during a bulb) //
+    TCCR3A = 0;
+    TCCR3B = (1 << CS31); // 8
+    tickSpan = 1;
+    tickBase = TCNT3;
+    OCR3B = tickBase + CLOCK_TICK_COUNTS;
+    TIFR3 = (1 << OCF3B) | (1 << OCF3A);
+    TIMSK3 = (1 << OCIE3B);
 
     wasSleeping = 0;
     sleepOk = 1;
     sleeping = 0;
+    idleOk = 0;
+    tickless = 1;
+    deepOk = 0;
+    wdtCounts = 0;
     reset();
 
     sei();
@@ -77,25 +81,327 @@ void Clock::init()
 
 void Clock::disable()
 {
-    TCCR2A = 0;
-    TCCR2B = 0;
-    OCR2A = 0;
-    ASSR = 0;
-    TIMSK2 = 0;
+    TCCR3B = 0;
+    TIMSK3 = 0;
 }
 
 /******************************************************************
  *
  *   Clock::count
- *
+ *   Called on the tick compare match.  Normally that's every ms,
+ *   but while idle the match can be pushed out to the next deadline
+ *   (see Clock::sleep) -- tickSpan is how many ms it covered.
  *
  ******************************************************************/
-uint8_t skips = 0;
 volatile void Clock::count()
 {
-    ms++;
-    event_ms++;
+    uint8_t span = tickSpan;
+
+    tickBase += (uint16_t)span * CLOCK_TICK_COUNTS;
+    while((uint16_t)(TCNT3 - tickBase) + CLOCK_TICK_MARGIN >= CLOCK_TICK_COUNTS) // held off by a long ISR -- catch up
+    {
+        tickBase += CLOCK_TICK_COUNTS;
+        span++;
+    }
+    tickSpan = 1;
+    OCR3B = tickBase + CLOCK_TICK_COUNTS;
+
+    wakeups++;
+    elapse(span);
+}
+
+/******************************************************************
+ *
+ *   Clock::elapse
+ *
+ *
+ ******************************************************************/
+
+void Clock::elapse(uint8_t span)
+{
+    runMs += span;
+    ms += span - skew;
+    event_ms += span;
+    skew = 0;
+
+    if(bulbRunning && bulbDurationPCsync && AUX_INPUT1)
+    {
+        // The camera's flash sync says the shutter is actually open now -- restart the end timing from here
+        bulbRemaining = bulbDurationPCsync * BULB_TICKS_PER_MS;
+        bulbDurationPCsync = 0;
+        bulbOpenMs = Ms();
+        bulbSchedule(TCNT3);
+    }
+
+    while(span--)
+    {
+        uint16_t due = 0;
+
+        wheelPos = (wheelPos + 1) & (CLOCK_WHEEL_SIZE - 1);
+        for(uint8_t i = wheel[wheelPos], n; i != CLOCK_TIMER_NONE; i = n)
+        {
+            n = timers[i].next;
+            if(timers[i].rounds)
+            {
+                timers[i].rounds--;
+                continue;
+            }
+            timerUnlink(i);
+            if(timers[i].flags & CLOCK_TIMER_PERIODIC) timerLink(i, timers[i].period);
+            if(timers[i].flags & CLOCK_TIMER_ISR) due |= (1 << i); else timersReady |= (1 << i);
+        }
+
+        // Callbacks may add or cancel timers, so only run them once the slot has been walked
+        for(uint8_t i = 0; due; i++, due >>= 1)
+        {
+            if(!(due & 1)) continue;
+            void (*func)() = timers[i].func;
+            if(!(timers[i].flags & CLOCK_TIMER_PERIODIC)) timerFree(i);
+            if(func) (*func)();
+        }
+    }
+
+    if(ms >= 1000)
+    {
+        ms -= 1000;
+        seconds++;
+        sleep_time++;
+        light_time++;
+        flashlight_time++;
+        idleMs += idleCounts / CLOCK_TICK_COUNTS;
+        idleCounts %= CLOCK_TICK_COUNTS;
+    }
+}
+
+/******************************************************************
+ *
+ *   Clock::pending
+ *   Whole ms elapsed since the last tick while it's stretched
+ *
+ ******************************************************************/
+
+uint16_t Clock::pending()
+{
+    uint16_t n = 0;
+    uint8_t sreg = SREG;
+
+    cli();
+    if(tickSpan > 1) n = (uint16_t)(TCNT3 - tickBase) / CLOCK_TICK_COUNTS;
+    SREG = sreg;
+
+    return n;
+}
+
+/******************************************************************
+ *
+ *   Clock::wakeAt
+ *   Asks for the main loop to run again by Ms() == atMs.  Cleared
+ *   after every Clock::idle, so tasks ask again each pass.
+ *
+ ******************************************************************/
+
+void Clock::wakeAt(uint32_t atMs)
+{
+    if(wakeMs == 0 || atMs < wakeMs) wakeMs = atMs ? atMs : 1;
+}
+
+/******************************************************************
+ *
+ *   Clock::idle
+ *   End of the main loop -- sleep until the next deadline
+ *
+ ******************************************************************/
+
+void Clock::idle()
+{
+    sleep(CLOCK_IDLE_MAX);
+    wakeMs = 0;
+    idleEndMs = Ms();
+}
+
+/******************************************************************
+ *
+ *   Clock::nap
+ *   Sleep while polling for something, at most maxMs.  Call with
+ *   interrupts disabled after enabling the interrupt that should
+ *   end the wait, so it can't slip in before the sleep.
+ *
+ ******************************************************************/
+
+void Clock::nap(uint16_t maxMs)
+{
+    sleep(maxMs);
+}
 
+/******************************************************************
+ *
+ *   Clock::sleep
+ *   Idles the CPU until any interrupt.  If nothing needs the 1 ms
+ *   tick (bulb, buttons, queued callbacks) the tick compare is
+ *   pushed out to the nearest deadline, up to maxMs.  Returns
+ *   straight away unless idleOk is set by the main loop.
+ *
+ ******************************************************************/
+
+void Clock::sleep(uint16_t maxMs)
+{
+    uint16_t span = maxMs, start, elapsed, next;
+    uint8_t want;
+
+    if(!idleOk || maxMs == 0)
+    {
+        sei();
+        return;
+    }
+
+    if(!tickless || newBulb || bulbRunning || !button.idle()) span = 1;
+
+    if(timersReady)
+    {
+        sei();
+        return; // callbacks to run first
+    }
+    next = timerNext(); // counted from the last tick, not from now
+    elapsed = pending();
+    next = next > elapsed ? next - elapsed : 1;
+    if(next < span) span = next;
+
+    if(wakeMs)
+    {
+        uint32_t now = Ms();
+        if(wakeMs <= now)
+        {
+            sei();
+            return;
+        }
+        if(wakeMs - now < span) span = (uint16_t)(wakeMs - now);
+    }
+
+    if(span > CLOCK_IDLE_MAX) span = CLOCK_IDLE_MAX;
+
+    if(deepOk && span == CLOCK_IDLE_MAX) // nothing due for a while, keys all up
+    {
+        deepSleep();
+        return;
+    }
+
+    cli();
+    start = TCNT3;
+    if((span > 1 || tickSpan > 1) && !(TIFR3 & (1 << OCF3B)))
+    {
+        elapsed = start - tickBase;
+        want = (uint8_t)(elapsed / CLOCK_TICK_COUNTS + span);
+        if((uint16_t)want * CLOCK_TICK_COUNTS < elapsed + CLOCK_TICK_MARGIN) want++;
+        tickSpan = want;
+        OCR3B = tickBase + (uint16_t)want * CLOCK_TICK_COUNTS;
+    }
+    sei();
+    sleep_cpu(); // the instruction after sei always runs first, so a pending interrupt still wakes us
+
+    cli();
+    idleCounts += (uint16_t)(TCNT3 - start);
+    sei();
+}
+
+/******************************************************************
+ *
+ *   Clock::deepSleep
+ *   Powers down for one WDT period, then credits the clock with
+ *   the WDT period as last measured on Timer3 and samples the keys
+ *   (only FL can wake us sooner).  Every CLOCK_DEEP_CAL times the
+ *   period is measured instead, in idle mode with Timer3 running.
+ *
+ ******************************************************************/
+
+void Clock::deepSleep()
+{
+    uint16_t counts, start;
+
+    cli();
+    wdtFired = 0;
+    wdtArm();
+    start = TCNT3;
+
+    if(wdtCounts == 0 || deepCal == 0)
+    {
+        for(;;)
+        {
+            cli();
+            if(wdtFired) break;
+            sei();
+            sleep_cpu();
+        }
+        wdtCounts = wdtStamp - start;
+        deepCal = CLOCK_DEEP_CAL;
+        wdt_enable(WDTO_4S); // back to the reset-only watchdog from setup()
+        sei();
+        return;
+    }
+
+    button.powerDown(1);
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sei();
+    sleep_cpu();
+
+    cli();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    button.powerDown(0);
+    counts = wdtFired ? wdtCounts : wdtCounts / 2; // woken early by FL, the time asleep isn't known
+    wdt_enable(WDTO_4S);
+
+    deepCounts += counts;
+    idleCounts += counts;
+    counts = deepCounts / CLOCK_TICK_COUNTS;
+    elapse((uint8_t)counts);
+    deepCounts %= CLOCK_TICK_COUNTS;
+    deepMs += counts;
+    deepSleeps++;
+    deepCal--;
+
+    button.sample(); // the tick that normally does this has been stopped
+    sei();
+}
+
+/******************************************************************
+ *
+ *   Clock::wdtArm
+ *   Watchdog in interrupt-then-reset mode: the first timeout wakes
+ *   us, a second one (if the ISR never ran) still resets.  Call
+ *   with interrupts disabled.
+ *
+ ******************************************************************/
+
+void Clock::wdtArm()
+{
+    wdt_reset();
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = (1 << WDIE) | (1 << WDE) | CLOCK_DEEP_WDT;
+}
+
+/******************************************************************
+ *
+ *   Clock::wdtWake
+ *   Called from the WDT interrupt
+ *
+ ******************************************************************/
+
+volatile void Clock::wdtWake()
+{
+    wdtStamp = TCNT3;
+    wdtFired = 1;
+}
+
+/******************************************************************
+ *
+ *   Clock::bulbCompare
+ *   Timer3 compare match -- opens the bulb, then counts it down in
+ *   chunks of less than one timer period and closes it on the
+ *   exact tick
+ *
+ ******************************************************************/
+
+volatile void Clock::bulbCompare()
+{
     if(newBulb)
     {
         if(conf.auxPort == AUX_MODE_SYNC && !AUX_INPUT1)
@@ -106,74 +412,109 @@ volatile void Clock::count()
         {
             bulbDurationPCsync = 0;
         }
+        bulbOpenMs = Ms();
         shutter_bulbStart();
         newBulb = 0;
         bulbRunning = 1;
+
+        bulbRemaining = bulbDuration * BULB_TICKS_PER_MS;
         if(conf.camera.negBulbOffset)
         {
-            bulbDuration -= conf.camera.bulbOffset;
+            uint32_t offset = (uint32_t)conf.camera.bulbOffset * BULB_TICKS_PER_MS;
+            bulbRemaining = bulbRemaining > offset ? bulbRemaining - offset : 0;
         }
         else
         {
-            bulbDuration += conf.camera.bulbOffset;
+            bulbRemaining += (uint32_t)conf.camera.bulbOffset * BULB_TICKS_PER_MS;
         }
-        skips++;
-        return;
+        bulbSchedule(TCNT3);
+    }
+    else if(bulbRunning && bulbRemaining)
+    {
+        bulbSchedule(OCR3A);
     }
     else if(bulbRunning)
     {
-        bulbDuration--;
-        if(bulbDuration <= 0)
-        {
-            shutter_bulbEnd();
-            bulbRunning = 0;
-            light.skipTask = 0;
-            if(conf.auxPort == AUX_MODE_SYNC && bulbDurationPCsync == 0) usingSync = 1; else usingSync = 0;
-            skips++;
-            return;
-        }
-        else if(bulbDurationPCsync && AUX_INPUT1)
-        {
-            bulbDuration = bulbDurationPCsync;
-            bulbDurationPCsync = 0;
-            skips++;
-            return;
-        }
+        TIMSK3 &= ~(1 << OCIE3A);
+        bulbCloseMs = Ms();
+        shutter_bulbEnd();
+        bulbRunning = 0;
+        light.skipTask = 0;
+        if(conf.auxPort == AUX_MODE_SYNC && bulbDurationPCsync == 0) usingSync = 1; else usingSync = 0;
     }
-
-    for(uint8_t i = 0; i < CLOCK_IN_QUEUE; i++)
+    else
     {
-        if(inTime[i] > 0)
-        {
-            inTime[i] -= 1 + skips;
-            if(inTime[i] <= 0)
-            {
-                (*inFunction[i])();
-            }
-        }
+        TIMSK3 &= ~(1 << OCIE3A);
     }
+}
 
-    if(ms >= 1000)
+/******************************************************************
+ *
+ *   Clock::bulbSchedule
+ *   Sets the next compare match relative to 'from'.  Long bulbs are
+ *   split so no step is shorter than BULB_MIN_TICKS.
+ *
+ ******************************************************************/
+
+void Clock::bulbSchedule(uint16_t from)
+{
+    uint16_t step;
+
+    if(bulbRemaining > 2 * BULB_MAX_STEP)
+        step = BULB_MAX_STEP;
+    else if(bulbRemaining > BULB_MAX_STEP)
+        step = bulbRemaining / 2;
+    else if(bulbRemaining > BULB_MIN_TICKS)
+        step = bulbRemaining;
+    else
+        step = BULB_MIN_TICKS;
+
+    bulbRemaining = bulbRemaining > step ? bulbRemaining - step : 0;
+
+    OCR3A = from + step;
+    TIFR3 = (1 << OCF3A); // drop a match that was already pending for the old schedule
+    TIMSK3 |= (1 << OCIE3A);
+}
+
+/******************************************************************
+ *
+ *   Clock::hold
+ *   Credits a stretched tick up to now and goes back to 1 ms
+ *   ticks, so advance() only has to add the blocked time.  Call
+ *   with interrupts disabled, before the block.
+ *
+ ******************************************************************/
+
+void Clock::hold()
+{
+    uint8_t span;
+
+    if(tickSpan > 1)
     {
-        ms -= 1000;
-        seconds++;
-        sleep_time++;
-        light_time++;
-        flashlight_time++;
+        span = (uint8_t)((uint16_t)(TCNT3 - tickBase) / CLOCK_TICK_COUNTS);
+        tickBase += (uint16_t)span * CLOCK_TICK_COUNTS;
+        tickSpan = 1;
+        OCR3B = tickBase + CLOCK_TICK_COUNTS;
+        TIFR3 = (1 << OCF3B);
+        elapse(span);
     }
-    skips = 0;
 }
 
 /******************************************************************
  *
  *   Clock::advance
- *   Only call with interrupts disabled!
+ *   Only call with interrupts disabled, after hold()!
  *
  ******************************************************************/
 
 void Clock::advance(uint8_t advance_ms)
 {
-    while(advance_ms--) count();
+    // The caller knows how long the tick was held off (Timer3 may have wrapped meanwhile); restart it from now
+    elapse(advance_ms);
+    tickSpan = 1;
+    tickBase = TCNT3;
+    OCR3B = tickBase + CLOCK_TICK_COUNTS;
+    TIFR3 = (1 << OCF3B);
 }
 
 /******************************************************************
@@ -185,9 +526,11 @@ void Clock::advance(uint8_t advance_ms)
 
 void Clock::reset()
 {
-    event_ms = 0;
+    skew = (uint8_t)pending(); // Ms() counts from here, not from the last tick
+    event_ms = 0 - skew;
     seconds = 0;
     ms = 0;
+    TIMSK3 &= ~(1 << OCIE3A);
     bulbRunning = 0;
     newBulb = 0;
     usingSync = 0;
@@ -202,7 +545,7 @@ void Clock::reset()
 
 void Clock::tare()
 {
-    event_ms = 0;
+    event_ms = 0 - pending();
 }
 
 /******************************************************************
@@ -235,6 +578,8 @@ void Clock::awake()
 
 void Clock::task()
 {
+    runTimers();
+
     if(!sleepOk)
     {
         sleep_time = 0;
@@ -286,7 +631,7 @@ void Clock::task()
 
 uint32_t Clock::eventMs()
 {
-    return event_ms;
+    return event_ms + pending();
 }
 
 /******************************************************************
@@ -298,7 +643,27 @@ uint32_t Clock::eventMs()
 
 uint32_t Clock::Ms()
 {
-    return (uint32_t)ms + seconds * 1000;
+    return (uint32_t)ms + seconds * 1000 + pending() - skew;
+}
+
+/******************************************************************
+ *
+ *   Clock::stamp
+ *   Free-running ms count for timestamping events, wraps at 65536.
+ *   Safe to call from an ISR.
+ *
+ ******************************************************************/
+
+uint16_t Clock::stamp()
+{
+    uint16_t n;
+    uint8_t sreg = SREG;
+
+    cli();
+    n = (uint16_t)runMs + pending();
+    SREG = sreg;
+
+    return n;
 }
 
 /******************************************************************
@@ -310,7 +675,7 @@ uint32_t Clock::Ms()
 
 uint32_t Clock::Seconds()
 {
-    return seconds;
+    return seconds + ((uint32_t)ms + pending() - skew) / 1000;
 }
 
 /******************************************************************
@@ -341,9 +706,26 @@ void Clock::bulb(uint32_t duration)
 {
     if(conf.auxPort == AUX_MODE_SYNC) ENABLE_AUX_PORT1;
     light.skipTask = 1; // don't read I2C during timing
+    cli();
     bulbRunning = 0;
     bulbDuration = duration;
     newBulb = 1;
+    OCR3A = TCNT3 + BULB_START_TICKS;
+    TIFR3 = (1 << OCF3A);
+    TIMSK3 |= (1 << OCIE3A);
+    sei();
+}
+
+/******************************************************************
+ *
+ *   Clock::bulbBusy
+ *   true from Clock::bulb until the bulb has closed
+ *
+ ******************************************************************/
+
+uint8_t Clock::bulbBusy()
+{
+    return newBulb || bulbRunning;
 }
 
 /******************************************************************
@@ -355,6 +737,7 @@ void Clock::bulb(uint32_t duration)
 
 void Clock::cancelBulb()
 {
+    TIMSK3 &= ~(1 << OCIE3A);
     light.skipTask = 0;
     bulbRunning = 0;
     bulbDuration = 0;
@@ -368,17 +751,182 @@ void Clock::cancelBulb()
  *
  ******************************************************************/
 
-void Clock::in(uint16_t stime, void (*func)())
+uint8_t Clock::in(uint16_t stime, void (*func)(), uint8_t flags)
+{
+    return timerAdd(stime, func, flags & ~CLOCK_TIMER_PERIODIC, 0);
+}
+
+/******************************************************************
+ *
+ *   Clock::every
+ *   Periodic timer, first call after one period.  Each expiry is
+ *   rescheduled from the tick it was due on, so it doesn't drift.
+ *
+ ******************************************************************/
+
+uint8_t Clock::every(uint16_t period, void (*func)(), uint8_t flags)
+{
+    if(period == 0) period = 1;
+    return timerAdd(period, func, flags | CLOCK_TIMER_PERIODIC, period);
+}
+
+/******************************************************************
+ *
+ *   Clock::cancel
+ *   Safe to call with a stale or zero handle
+ *
+ ******************************************************************/
+
+void Clock::cancel(uint8_t handle)
 {
-    for(uint8_t i = 0; i < CLOCK_IN_QUEUE; i++)
+    uint8_t i = (handle & 0x0F) - 1;
+    uint8_t sreg = SREG;
+
+    cli();
+    if(i < CLOCK_TIMERS && timers[i].func && timers[i].gen == (handle >> 4)) timerFree(i);
+    SREG = sreg;
+}
+
+/******************************************************************
+ *
+ *   Clock::runTimers
+ *   Runs the callbacks that came due, from the main loop
+ *
+ ******************************************************************/
+
+void Clock::runTimers()
+{
+    for(uint8_t i = 0; i < CLOCK_TIMERS && timersReady; i++)
     {
-        if(inTime[i] <= 0)
-        {
-            inFunction[i] = func;
-            inTime[i] = stime;
-            break;
-        }
+        if(!(timersReady & (1 << i))) continue;
+
+        cli();
+        timersReady &= ~(1 << i);
+        void (*func)() = timers[i].func;
+        if(!(timers[i].flags & CLOCK_TIMER_PERIODIC)) timerFree(i);
+        sei();
+
+        if(func) (*func)();
+    }
+}
+
+/******************************************************************
+ *
+ *   Clock::timerAdd
+ *   Returns the handle, or 0 (and counts it) if the pool is full
+ *
+ ******************************************************************/
+
+uint8_t Clock::timerAdd(uint16_t stime, void (*func)(), uint8_t flags, uint16_t period)
+{
+    uint8_t i, handle = 0;
+    uint8_t sreg = SREG;
+
+    if(stime == 0) stime = 1;
+
+    cli();
+    for(i = 0; i < CLOCK_TIMERS; i++)
+    {
+        if(timers[i].func == 0) break;
+    }
+    if(i < CLOCK_TIMERS)
+    {
+        timers[i].func = func;
+        timers[i].flags = flags;
+        timers[i].period = period;
+        timers[i].slot = CLOCK_TIMER_NONE;
+        if(++timers[i].gen > 0x0F) timers[i].gen = 1;
+        timerLink(i, stime + pending()); // the current tick may already be partly gone
+        handle = (timers[i].gen << 4) | (i + 1);
+        if(++timersUsed > timersMax) timersMax = timersUsed;
+    }
+    else
+    {
+        timerOverflows++;
+    }
+    SREG = sreg;
+
+    return handle;
+}
+
+/******************************************************************
+ *
+ *   Clock::timerLink
+ *   Puts timer i on the wheel, due stime ms from the current slot
+ *   (interrupts must be off)
+ *
+ ******************************************************************/
+
+void Clock::timerLink(uint8_t i, uint16_t stime)
+{
+    uint8_t slot = (wheelPos + stime) & (CLOCK_WHEEL_SIZE - 1);
+    uint8_t first = ((slot - wheelPos - 1) & (CLOCK_WHEEL_SIZE - 1)) + 1; // ms until the slot next comes up
+
+    timers[i].rounds = (stime - first) / CLOCK_WHEEL_SIZE;
+    timers[i].slot = slot;
+    timers[i].prev = CLOCK_TIMER_NONE;
+    timers[i].next = wheel[slot];
+    if(wheel[slot] != CLOCK_TIMER_NONE) timers[wheel[slot]].prev = i;
+    wheel[slot] = i;
+}
+
+/******************************************************************
+ *
+ *   Clock::timerUnlink
+ *   (interrupts must be off)
+ *
+ ******************************************************************/
+
+void Clock::timerUnlink(uint8_t i)
+{
+    if(timers[i].slot == CLOCK_TIMER_NONE) return;
+
+    if(timers[i].prev != CLOCK_TIMER_NONE)
+        timers[timers[i].prev].next = timers[i].next;
+    else
+        wheel[timers[i].slot] = timers[i].next;
+    if(timers[i].next != CLOCK_TIMER_NONE) timers[timers[i].next].prev = timers[i].prev;
+
+    timers[i].slot = CLOCK_TIMER_NONE;
+}
+
+/******************************************************************
+ *
+ *   Clock::timerFree
+ *   (interrupts must be off)
+ *
+ ******************************************************************/
+
+void Clock::timerFree(uint8_t i)
+{
+    timerUnlink(i);
+    timersReady &= ~(1 << i);
+    timers[i].func = 0;
+    timersUsed--;
+}
+
+/******************************************************************
+ *
+ *   Clock::timerNext
+ *   ms until the next timer is due, for the idle sleep
+ *
+ ******************************************************************/
+
+uint16_t Clock::timerNext()
+{
+    uint16_t next = 0xFFFF, t;
+    uint8_t sreg = SREG;
+
+    cli();
+    for(uint8_t i = 0; i < CLOCK_TIMERS; i++)
+    {
+        if(timers[i].func == 0 || timers[i].slot == CLOCK_TIMER_NONE) continue;
+        t = ((timers[i].slot - wheelPos - 1) & (CLOCK_WHEEL_SIZE - 1)) + 1 + timers[i].rounds * CLOCK_WHEEL_SIZE;
+        if(t < next) next = t;
     }
+    SREG = sreg;
+
+    return next;
 }
 
 /******************************************************************
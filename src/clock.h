@@ -11,7 +11,41 @@
 #define CLOCK_TUNE 134
 //#define CLOCK_TUNE 8
 
-#define CLOCK_IN_QUEUE 3
+// Timers: a hashed wheel of 1 ms slots; a timer further out than one turn waits 'rounds' turns //
+#define CLOCK_TIMERS 12         // pool size, at most 15 (handle is gen << 4 | index + 1)
+#define CLOCK_WHEEL_SIZE 32     // power of 2
+#define CLOCK_TIMER_NONE 0xFF
+
+#define CLOCK_TIMER_ISR 0x01      // run from the tick itself -- only for short pin-level work
+#define CLOCK_TIMER_PERIODIC 0x02
+
+struct clock_timer_t
+{
+    void (*func)();   // 0 when the timer is free
+    uint16_t period;
+    uint16_t rounds;
+    uint8_t prev, next; // in the wheel slot list
+    uint8_t slot;       // wheel slot, CLOCK_TIMER_NONE when not linked
+    uint8_t flags;
+    uint8_t gen;
+};
+
+// The system tick is Timer3 compare B, with the same period as the old Timer2 setting (123 * 64 cycles) //
+#define CLOCK_TICK_COUNTS 984
+#define CLOCK_TICK_MARGIN 20 // counts, a compare closer than this is treated as already passed
+#define CLOCK_IDLE_MAX 50    // ms, longest stretched tick (must stay below 65536 / CLOCK_TICK_COUNTS)
+
+// Power-down while the UI is idle -- Timer3 stops, so the WDT wakes us to sample the keys //
+#define CLOCK_DEEP_WDT WDTO_30MS // nominally 32 ms on the WDT oscillator
+#define CLOCK_DEEP_CAL 200       // power-downs between measuring the WDT period against Timer3
+
+// Bulb timing runs on Timer3 (16-bit, F_CPU/8 = 1us per tick at 8MHz).  Bulb lengths and offsets
+// are in system ms (CLOCK_TICK_COUNTS ticks, 0.984 real ms), as they were when the tick timed them,
+// so existing bulbOffset calibrations and the bulb stats measured with Ms() still line up //
+#define BULB_TICKS_PER_MS CLOCK_TICK_COUNTS
+#define BULB_MAX_STEP 50000 // ticks, keeps each compare well inside the 65536 tick wrap
+#define BULB_MIN_TICKS 40   // ticks, enough for the ISR to set the next compare before it passes
+#define BULB_START_TICKS 100
 
 class Clock
 {
@@ -21,6 +55,8 @@ public:
     void init();
     void disable();
     volatile void count();
+    volatile void bulbCompare();
+    void hold();
     void advance(uint8_t advance_ms);
     void reset();
     void tare();
@@ -33,23 +69,67 @@ public:
     uint16_t ms;
     uint32_t Seconds();
     uint32_t Ms();
+    uint16_t stamp();
     uint8_t sleepOk;
     uint8_t sleeping;
 
+    void idle();
+    void nap(uint16_t maxMs);
+    void wakeAt(uint32_t atMs);
+    uint8_t idleOk, tickless;
+    uint8_t deepOk; // set by the main loop when power-down is allowed
+    uint32_t idleMs, runMs, wakeups; // for measuring what the idle sleep saves
+    uint32_t idleEndMs; // Ms() when the last idle() returned
+    uint32_t deepSleeps, deepMs;
+    volatile void wdtWake();
+    uint16_t tickUs, tickUsMax;      // time spent in the tick ISR, in Timer3 ticks (us)
+
     uint8_t bulbRunning, usingSync;
+    uint32_t bulbOpenMs, bulbCloseMs; // shutter open (PC sync edge if available) and close times
 
     void bulb(uint32_t duration);
     void cancelBulb(void);
-    void in(uint16_t stime, void (*func)());
+    uint8_t bulbBusy(void);
+    uint8_t in(uint16_t stime, void (*func)(), uint8_t flags = 0);
+    uint8_t every(uint16_t period, void (*func)(), uint8_t flags = 0);
+    void cancel(uint8_t handle);
+    void runTimers();
+    uint8_t timersUsed, timersMax;
+    uint16_t timerOverflows; // in()/every() calls refused because the pool was full
 
 private:
+    void bulbSchedule(uint16_t from);
+    void sleep(uint16_t maxMs);
+    void deepSleep();
+    void wdtArm();
+    void elapse(uint8_t span);
+    uint16_t pending();
+    uint8_t timerAdd(uint16_t stime, void (*func)(), uint8_t flags, uint16_t period);
+    void timerLink(uint8_t i, uint16_t stime);
+    void timerUnlink(uint8_t i);
+    void timerFree(uint8_t i);
+    uint16_t timerNext();
+
+    volatile uint16_t tickBase;
+    volatile uint8_t tickSpan;
+    uint8_t skew;
+    uint32_t wakeMs;
+    uint32_t idleCounts;
+    uint16_t wdtCounts;  // Timer3 counts per WDT period, 0 until measured
+    uint16_t deepCounts; // credited counts short of a whole ms
+    uint8_t deepCal;
+    volatile uint8_t wdtFired;
+    volatile uint16_t wdtStamp;
+
     uint32_t bulbDuration;
     uint32_t bulbDurationPCsync;
+    uint32_t bulbRemaining; // Timer3 ticks
     uint8_t newBulb;
 
-    uint8_t inIndex;
-    uint16_t inTime[CLOCK_IN_QUEUE];
-    void (*inFunction[CLOCK_IN_QUEUE])();
+    clock_timer_t timers[CLOCK_TIMERS];
+    uint8_t wheel[CLOCK_WHEEL_SIZE]; // first timer in each slot
+    uint8_t wheelPos;
+    volatile uint16_t timersReady;   // deferred callbacks due, one bit per timer
 
     uint8_t sleepWasOk;
     uint16_t light_time;
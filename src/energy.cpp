@@ -0,0 +1,156 @@
+/*
+ *  energy.cpp
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include <string.h>
+#include "energy.h"
+#include "clock.h"
+#include "5110LCD.h"
+#include "bluetooth.h"
+#include "light.h"
+#include "shutter.h"
+
+extern Clock clock;
+extern LCD lcd;
+extern BT bt;
+extern Light light;
+extern shutter timer;
+extern uint8_t USBmode, battery_percent;
+
+const uint16_t energy_ua[ENERGY_CONSUMERS] PROGMEM = ENERGY_UA;
+
+/******************************************************************
+ *
+ *   Energy Class
+ *   On-time of each power consumer, times its estimated current
+ *
+ ******************************************************************/
+
+Energy::Energy()
+{
+    reset();
+}
+
+/******************************************************************
+ *
+ *   Energy::reset
+ *
+ *
+ ******************************************************************/
+
+void Energy::reset()
+{
+    uint8_t sreg = SREG;
+
+    memset(&ledger, 0, sizeof(ledger));
+    for(uint8_t i = 0; i < ENERGY_CONSUMERS; i++) ledger.uA[i] = pgm_read_word(&energy_ua[i]);
+
+    cli();
+    lastRun = clock.runMs;
+    lastIdle = clock.idleMs;
+    lastDeep = clock.deepMs;
+    SREG = sreg;
+    lastMs = clock.Ms();
+}
+
+/******************************************************************
+ *
+ *   Energy::add
+ *
+ *
+ ******************************************************************/
+
+void Energy::add(uint8_t consumer, uint32_t ms)
+{
+    ledger.onMs[consumer] += ms;
+    stepUAms += (float)ms * ledger.uA[consumer];
+}
+
+/******************************************************************
+ *
+ *   Energy::task
+ *   Run every ENERGY_SAMPLE_MS by the scheduler.  The CPU split
+ *   comes from the clock's own run/idle/power-down counters; the
+ *   rest are sampled, so each on/off change is placed to within
+ *   one sample.
+ *
+ ******************************************************************/
+
+void Energy::task()
+{
+    uint32_t now = clock.Ms();
+    uint32_t dt = now - lastMs;
+    uint32_t run, idle, deep;
+
+    if((int32_t)dt <= 0) // Clock::reset() moved Ms() back
+    {
+        lastMs = now;
+        return;
+    }
+
+    cli();
+    run = clock.runMs - lastRun;
+    idle = clock.idleMs - lastIdle;
+    deep = clock.deepMs - lastDeep;
+    lastRun += run;
+    lastIdle += idle;
+    lastDeep += deep;
+    sei();
+    lastMs = now;
+
+    if(idle > run) idle = run; // idleMs is only brought up to date once a second
+    if(deep > idle) deep = idle;
+
+    stepUAms = 0;
+    add(ENERGY_CPU_RUN, run - idle);
+    add(ENERGY_CPU_IDLE, idle - deep);
+    add(ENERGY_CPU_DOWN, deep);
+    add(ENERGY_BASE, dt);
+    if(lcd.getBacklight() > 0) add(ENERGY_BACKLIGHT, dt);
+    if(bt.present && bt.state != BT_ST_SLEEP) add(ENERGY_BT, dt);
+    if(USBmode == 1) add(ENERGY_USB_HOST, dt);
+    if(light.initialized) add(ENERGY_LIGHT, dt);
+    ledger.elapsedMs += dt;
+
+    float ma = stepUAms / (float)dt / 1000.0;
+
+    if(ledger.elapsedMs == dt)
+    {
+        ledger.avgMa = ma;
+    }
+    else
+    {
+        float k = (float)dt / ((float)ENERGY_AVG_SECONDS * 1000.0);
+        if(k > 1.0) k = 1.0;
+        ledger.avgMa += (ma - ledger.avgMa) * k;
+    }
+
+    float minutes = ledger.avgMa > 0.0 ? (float)battery_percent / 100.0 * BATTERY_CAPACITY_MAH / ledger.avgMa * 60.0 : 0.0;
+    ledger.batteryMinutes = minutes > 65535.0 ? 65535 : (uint16_t)minutes;
+
+    if(timer.running && !timer.status.infinitePhotos)
+        ledger.programMinutes = (uint16_t)(((uint32_t)timer.status.photosRemaining * timer.status.interval / 10 + 59) / 60);
+    else
+        ledger.programMinutes = 0;
+}
+
+/******************************************************************
+ *
+ *   Energy::mAh
+ *   Charge drawn by one consumer since the last reset
+ *
+ ******************************************************************/
+
+float Energy::mAh(uint8_t consumer)
+{
+    return (float)ledger.onMs[consumer] * (float)ledger.uA[consumer] / 3600000000.0;
+}
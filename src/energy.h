@@ -0,0 +1,54 @@
+/*
+ *  energy.h
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+// Power consumers tracked by the ledger //
+#define ENERGY_CPU_RUN 0
+#define ENERGY_CPU_IDLE 1
+#define ENERGY_CPU_DOWN 2
+#define ENERGY_BACKLIGHT 3
+#define ENERGY_BT 4
+#define ENERGY_USB_HOST 5
+#define ENERGY_LIGHT 6
+#define ENERGY_BASE 7 // regulator, LCD controller -- always on
+#define ENERGY_CONSUMERS 8
+
+// Supply current of each consumer in uA, in the order above.  These are //
+// datasheet estimates; measure a board and adjust to tighten the numbers. //
+#define ENERGY_UA { 6000, 2500, 60, 15000, 1500, 20000, 300, 400 }
+
+#define BATTERY_CAPACITY_MAH 1000
+#define ENERGY_SAMPLE_MS 1000  // how often the consumer states are sampled
+#define ENERGY_AVG_SECONDS 600 // time constant of the draw average for projections
+
+struct energy_ledger
+{
+    uint32_t onMs[ENERGY_CONSUMERS];
+    uint16_t uA[ENERGY_CONSUMERS]; // the estimates used, so remote clients can work out charge
+    uint32_t elapsedMs;
+    float avgMa;              // recent average draw
+    uint16_t batteryMinutes;  // left at avgMa, from battery_percent
+    uint16_t programMinutes;  // left in the running program, 0 if none or open-ended
+};
+
+class Energy
+{
+public:
+    Energy();
+    void task();
+    void reset();
+    float mAh(uint8_t consumer);
+
+    energy_ledger ledger;
+
+private:
+    uint32_t lastMs, lastRun, lastIdle, lastDeep;
+    float stepUAms;
+    void add(uint8_t consumer, uint32_t ms);
+};
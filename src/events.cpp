@@ -0,0 +1,97 @@
+/*
+ *  events.cpp
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+#include <avr/io.h>
+#include "events.h"
+
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+// keeps the compiler from moving the slot copy past the index update //
+#define barrier() __asm__ __volatile__("" ::: "memory")
+
+/******************************************************************
+ *
+ *   EventQueue::EventQueue
+ *
+ *
+ ******************************************************************/
+
+EventQueue::EventQueue()
+{
+    head = 0;
+    tail = 0;
+    dropped = 0;
+    depthMax = 0;
+}
+
+/******************************************************************
+ *
+ *   EventQueue::post
+ *   Producer side, called from the ISR.  Returns 0 if the queue
+ *   was full; the caller should post again later rather than lose
+ *   the state change.
+ *
+ ******************************************************************/
+
+uint8_t EventQueue::post(uint8_t type, uint8_t data, uint16_t stamp)
+{
+    uint8_t h = head;
+    uint8_t next = (h + 1) & EVENT_QUEUE_MASK;
+
+    if(next == tail)
+    {
+        dropped++;
+        return 0;
+    }
+
+    queue[h].type = type;
+    queue[h].data = data;
+    queue[h].stamp = stamp;
+    barrier();
+    head = next;
+
+    uint8_t depth = (next - tail) & EVENT_QUEUE_MASK;
+    if(depth > depthMax) depthMax = depth;
+
+    return 1;
+}
+
+/******************************************************************
+ *
+ *   EventQueue::get
+ *   Consumer side, main loop only.  Copies out the oldest event,
+ *   returns 0 if there was none.
+ *
+ ******************************************************************/
+
+uint8_t EventQueue::get(event_t *e)
+{
+    uint8_t t = tail;
+
+    if(t == head) return 0;
+
+    *e = queue[t];
+    barrier();
+    tail = (t + 1) & EVENT_QUEUE_MASK;
+
+    return 1;
+}
+
+/******************************************************************
+ *
+ *   EventQueue::empty
+ *
+ *
+ ******************************************************************/
+
+uint8_t EventQueue::empty()
+{
+    return head == tail;
+}
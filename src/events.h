@@ -0,0 +1,38 @@
+/*
+ *  events.h
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+// Single producer (an ISR), single consumer (the main loop) //
+#define EVENT_QUEUE_SIZE 16 // power of 2, holds one less than this
+
+#define EVENT_BUTTONS 1     // data: raw key mask, bit n set while key n + 1 is down
+
+struct event_t
+{
+    uint8_t type;
+    uint8_t data;
+    uint16_t stamp; // Clock::stamp() when it was posted
+};
+
+class EventQueue
+{
+public:
+    EventQueue();
+    uint8_t post(uint8_t type, uint8_t data, uint16_t stamp);
+    uint8_t get(event_t *e);
+    uint8_t empty();
+
+    uint16_t dropped; // posts refused because the queue was full
+    uint8_t depthMax;
+
+private:
+    event_t queue[EVENT_QUEUE_SIZE];
+    volatile uint8_t head; // written by the producer only
+    volatile uint8_t tail; // written by the consumer only
+};
@@ -2528,3 +2528,15 @@ const unsigned char font4_5[] [6] PROGMEM =
 
 };
 
+// Advance of each font4_5 character as measureCharTiny() reports it, from ' ' to 'z', 0xFF where
+// the character has no glyph
+const unsigned char font4_5_width[] PROGMEM =
+{
+	2, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 3, 0xFF, 3, 1, 5,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 5, 5, 5, 5, 5, 5, 5, 5, 4, 5, 5, 5, 6, 5, 5,
+	5, 5, 5, 5, 4, 5, 4, 6, 5, 4, 5, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 5, 5, 5, 5, 5, 5, 5, 5, 4, 5, 5, 5, 6, 5, 5,
+	5, 5, 5, 5, 4, 5, 4, 6, 5, 4, 5
+};
+
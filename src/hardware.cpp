@@ -26,6 +26,7 @@
 #include "bluetooth.h"
 #include "TWI_Master.h"
 #include "math.h"
+#include "adc.h"
 #include <LUFA/Common/Common.h>
 #include <LUFA/Drivers/USB/USB.h>
 #include <LUFA/Drivers/Peripheral/ADC.h>
@@ -52,6 +53,10 @@ uint16_t battery_high EEMEM;
 
 char backlightVal;
 
+static int8_t battery_adc = -1;
+static uint8_t charge_polling;
+static char charge_reading, charge_last;
+
 
 
 
@@ -117,6 +122,9 @@ void hardware_off(void)
             bt.disconnect();
             bt.sleep();
 
+            // Let the last frame finish going out
+            lcd.wait();
+
             // Disable all interrupts
             cli();
 
@@ -354,13 +362,84 @@ uint8_t battery_read() // Returns 0-100 //
 
 uint16_t battery_read_raw()
 {
-    setBit(PF1, DDRF); // Powers Sensor //
-    clrBit(PF1, PORTF);
-    _delay_ms(10);
-    uint16_t battery = hardware_analogRead(2);
-    clrBit(PF1, DDRF); // Shuts down Sensor //
-    
-    return battery;
+    if(adc_valid(battery_adc))
+        return adc_read(battery_adc);
+
+    return adc_readNow(2, &battery_power, 10); // powered from after any background reading until done
+}
+
+/******************************************************************
+ *
+ *   battery_init
+ *   Hands the battery sense input to the background ADC
+ *
+ ******************************************************************/
+
+void battery_init()
+{
+    battery_adc = adc_channel(2, BATTERY_SAMPLE_MS, 4, 2, 10, &battery_power);
+}
+
+/******************************************************************
+ *
+ *   battery_power
+ *
+ *
+ ******************************************************************/
+
+void battery_power(uint8_t on)
+{
+    if(on)
+    {
+        setBit(PF1, DDRF); // Powers Sensor //
+        clrBit(PF1, PORTF);
+    }
+    else
+    {
+        clrBit(PF1, DDRF); // Shuts down Sensor //
+    }
+}
+
+/******************************************************************
+ *
+ *   battery_status_poll
+ *   Returns the last charge status and starts the next reading,
+ *   timed with clock callbacks instead of waiting out the 20 ms
+ *
+ ******************************************************************/
+
+char battery_status_poll()
+{
+    if(!charge_polling)
+    {
+        setIn(CHARGE_STATUS_PIN);
+        setHigh(CHARGE_STATUS_PIN);
+        if(clock.in(10, &battery_status_high))
+            charge_polling = 1;
+        else
+            charge_last = battery_status();
+    }
+
+    return charge_last;
+}
+
+void battery_status_high()
+{
+    charge_reading = getPin(CHARGE_STATUS_PIN) ? 0 : 1;
+    setLow(CHARGE_STATUS_PIN);
+    if(!clock.in(10, &battery_status_low))
+    {
+        _delay_ms(10);
+        battery_status_low();
+    }
+}
+
+void battery_status_low()
+{
+    if(getPin(CHARGE_STATUS_PIN)) 
+        charge_reading = 2;
+    charge_last = charge_reading;
+    charge_polling = 0;
 }
 
 /******************************************************************
@@ -390,8 +469,6 @@ char battery_status()
     return stat;
 }
 
-#define ADC_READINGS 100
-
 /******************************************************************
  *
  *   hardware_analogRead
@@ -401,37 +478,7 @@ char battery_status()
 
 uint16_t hardware_analogRead(uint8_t ch)
 {
-    uint32_t buf = 0;
-
-    // Initialize the ADC driver before first use
-    ADC_Init(ADC_FREE_RUNNING | ADC_PRESCALE_32);
-
-    // Must setup the ADC channel to read beforehand
-    if(ch < 15) 
-        ADC_SetupChannel(ch);
-    
-    if(ch > 7) 
-        ch = (1 << 8 | ((ch - 8) << MUX0));
-    else 
-        ch = ch << MUX0;
-
-    // Perform a single conversion of the ADC channel 1
-//  buf = ADC_GetChannelReading(ADC_REFERENCE_AVCC | ADC_RIGHT_ADJUSTED | ch);
-
-    // Start reading ADC channel 1 in free running (continuous conversion) mode
-    ADC_StartReading(ADC_REFERENCE_AVCC | ADC_RIGHT_ADJUSTED | ch);
-    
-    for(uint8_t i = 0; i < ADC_READINGS; i++)
-    {
-        while (!(ADC_IsReadingComplete()));
-        
-        buf += ADC_GetResult();
-    }
-
-    // Leave ADC Disabled to save power
-    ADC_Disable();
-
-    return (uint16_t)(buf / ADC_READINGS);
+    return adc_readNow(ch);
 }
 
 /******************************************************************
@@ -19,6 +19,8 @@
 #include "hardware_map_20120703.h"
 #endif
 
+#define BATTERY_SAMPLE_MS 10000 // background battery readings, 16 conversions each
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -48,6 +50,11 @@ void hardware_light_disable(void);
 uint16_t battery_read_raw(void);
 uint8_t battery_read(void);
 char battery_status(void);
+char battery_status_poll(void);
+void battery_status_high(void);
+void battery_status_low(void);
+void battery_init(void);
+void battery_power(uint8_t on);
 
 #ifdef __cplusplus
 }
@@ -29,6 +29,7 @@ public:
     float lockedSlope, slope, integrated, median;
 	uint8_t method, paused, skipTask, scale;
 	bool underThreshold;
+    uint8_t initialized; // sensor powered and configured
 
 private:
     float iev[LIGHT_INTEGRATION_COUNT];
@@ -37,7 +38,6 @@ private:
     int8_t wasPaused;
     uint16_t integration;
     uint32_t lastSeconds;
-    uint8_t initialized;
     uint16_t offset;
     bool integrationActive;
 
@@ -6,10 +6,12 @@
 
 extern settings_t conf;
 
+volatile uint8_t notify_version[WATCH_ITEMS];
+
 /******************************************************************
  *
  *   Notify Class
- *   Watches variables and calls handlers on changes
+ *   Calls handlers when watched items are changed
  *
  ******************************************************************/
 Notify::Notify()
@@ -19,22 +21,16 @@ Notify::Notify()
 
 void Notify::task()
 {
-    uint8_t i;
+    uint8_t i, v;
 
     for(i = 0; i < MAX_ITEMS_WATCHED; i++)
     {
         if(watchedItems[i].active)
         {
-            uint8_t x, sum = 0, xsum = 0;
-            for(x = 0; x < watchedItems[i].size; x++)
-            {
-                xsum ^= ((char *) watchedItems[i].item)[x];
-                sum += ((char *) watchedItems[i].item)[x];
-            }
-            if(sum != watchedItems[i].chksum || xsum != watchedItems[i].chkxsum)
+            v = notify_version[watchedItems[i].item];
+            if(v != watchedItems[i].version)
             {
-                watchedItems[i].chksum = sum;
-                watchedItems[i].chkxsum = xsum;
+                watchedItems[i].version = v;
                 // Run Notification Handler
                 ((void (*)(uint8_t))watchedItems[i].handler)(watchedItems[i].id);
             }
@@ -42,7 +38,19 @@ void Notify::task()
     }
 }
 
-void Notify::watch(uint8_t id, void * item, uint8_t size, void (handler)(uint8_t))
+/******************************************************************
+ *
+ *   Notify::changed
+ *   Publishes a change to a watchable item (WATCH_*)
+ *
+ ******************************************************************/
+
+void Notify::changed(uint8_t item)
+{
+    NOTIFY_CHANGED(item);
+}
+
+void Notify::watch(uint8_t id, uint8_t item, void (handler)(uint8_t))
 {
     uint8_t i;
     unWatch(id, handler);
@@ -52,17 +60,9 @@ void Notify::watch(uint8_t id, void * item, uint8_t size, void (handler)(uint8_t
         {
             watchedItems[i].active = 1;
             watchedItems[i].id = id;
-            watchedItems[i].size = size;
             watchedItems[i].item = item;
+            watchedItems[i].version = notify_version[item];
             watchedItems[i].handler = (void*)handler;
-            uint8_t x, sum = 0, xsum = 0;
-            for(x = 0; x < size; x++)
-            {
-                xsum ^= ((char *) item)[x];
-                sum += ((char *) item)[x];
-            }
-            watchedItems[i].chksum = sum;
-            watchedItems[i].chkxsum = xsum;
             return;
         }
     }
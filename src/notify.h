@@ -1,12 +1,42 @@
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
 #define MAX_ITEMS_WATCHED 15
 
+// Watchable items.  Whoever modifies one calls notify.changed(item) (or
+// NOTIFY_CHANGED(item) from C) afterwards, and only when the value
+// actually changed; Notify::task compares versions instead of reading
+// the items.
+#define WATCH_STATUS 0       // timer.status
+#define WATCH_PROGRAM 1      // timer.current
+#define WATCH_BATTERY 2      // battery_percent
+#define WATCH_RUNNING 3      // timer.running
+#define WATCH_CAMERA_FPS 4   // conf.camera.cameraFPS
+#define WATCH_CAMERA_MAKE 5  // conf.camera.cameraMake
+#define WATCH_VIDEO 6        // camera.recording
+#define WATCH_LIVEVIEW 7     // camera.modeLiveView
+#define WATCH_CHARGE 8       // charge_status
+#define WATCH_BT 9           // remote.connected
+#define WATCH_CAMERA 10      // PTP_Ready
+#define WATCH_ITEMS 11
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern volatile uint8_t notify_version[WATCH_ITEMS];
+#ifdef __cplusplus
+}
+#endif
+
+#define NOTIFY_CHANGED(item) notify_version[item]++
+
+#ifdef __cplusplus
+
 struct watched_item_struct
 {
-    void *item;
-    uint8_t chksum;
-    uint8_t chkxsum;
+    uint8_t item;
+    uint8_t version;
     void *handler;
-    uint8_t size;
     uint8_t active;
     uint8_t id;
 };
@@ -18,14 +48,17 @@ class Notify
 public:
     Notify(void);
     void task(void);
+    void changed(uint8_t item);
 
-    void watch(uint8_t id, void * item, uint8_t size, void (handler)(uint8_t));
+    void watch(uint8_t id, uint8_t item, void (handler)(uint8_t));
     void unWatch(uint8_t id); // Unwatch all with specified id
     void unWatch(uint8_t id, void (handler)(uint8_t)); // Unwatch item with specified id & handler
     void unWatch(void (handler)(uint8_t)); // Unwatch all with specified handler
 
-
 private:
 	watched_item_struct watchedItems[MAX_ITEMS_WATCHED];
 };
 
+#endif
+
+#endif
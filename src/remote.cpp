@@ -28,6 +28,7 @@
 #include "tlp_menu_functions.h"
 #include "notify.h"
 #include "PTP.h"
+#include "energy.h"
 //#include "thm-sample.h"
 
 extern BT bt;
@@ -37,10 +38,57 @@ extern uint8_t battery_percent;
 extern settings_t conf;
 extern Notify notify;
 extern PTP camera;
+extern Energy energy;
+extern Clock clock;
+extern Remote remote;
+
+struct remote_notify_item
+{
+	uint8_t id;
+	uint8_t watch;
+	uint8_t offset; // in notifySent/notifyDirty
+	uint8_t size;
+	volatile void *data;
+};
+
+static const remote_notify_item notifyItems[REMOTE_NOTIFY_ITEMS] = {
+	{ REMOTE_STATUS, WATCH_STATUS, 0, sizeof(timer_status), &timer.status },
+	{ REMOTE_PROGRAM, WATCH_PROGRAM, sizeof(timer_status), sizeof(program), &timer.current },
+	{ REMOTE_BATTERY, WATCH_BATTERY, sizeof(timer_status) + sizeof(program), 1, &battery_percent },
+	{ REMOTE_START, WATCH_RUNNING, sizeof(timer_status) + sizeof(program) + 1, 1, &timer.running },
+	{ REMOTE_CAMERA_FPS, WATCH_CAMERA_FPS, sizeof(timer_status) + sizeof(program) + 2, 1, &conf.camera.cameraFPS },
+	{ REMOTE_CAMERA_MAKE, WATCH_CAMERA_MAKE, sizeof(timer_status) + sizeof(program) + 3, 1, &conf.camera.cameraMake },
+	{ REMOTE_VIDEO, WATCH_VIDEO, sizeof(timer_status) + sizeof(program) + 4, 1, &camera.recording },
+	{ REMOTE_LIVEVIEW, WATCH_LIVEVIEW, sizeof(timer_status) + sizeof(program) + 5, 1, &camera.modeLiveView }
+};
+
+// One packet per slot in the mask, then REMOTE_STORED_END
+static void sendStored(uint32_t slots)
+{
+	uint8_t packet[1 + sizeof(program)];
+
+	for(uint8_t i = 0; i < MAX_STORED; i++)
+	{
+		if(!(slots & ((uint32_t)1 << i))) continue;
+
+		packet[0] = i;
+		eeprom_read_block((void*)&packet[1], &stored[i], sizeof(program));
+		bt.sendDATA(REMOTE_STORED, REMOTE_TYPE_SEND, (void *) packet, packet[1] == 255 ? 1 : sizeof(packet));
+	}
+
+	packet[0] = REMOTE_STORED_END;
+	bt.sendDATA(REMOTE_STORED, REMOTE_TYPE_SEND, (void *) packet, 1);
+}
 
 Remote::Remote()
 {
 	requestActive = 0;
+	notifyDelta = 0;
+	notifyPending = 0;
+	notifyWhole = 0;
+	notifyAwaiting = 0;
+	notifySeq = 0;
+	memset(notifyDirty, 0, sizeof(notifyDirty));
 }
 
 uint8_t Remote::request(uint8_t id)
@@ -137,6 +185,34 @@ uint8_t Remote::send(uint8_t id, uint8_t type)
 			uint8_t tmp = camera.modeLiveView;
 			return bt.sendDATA(id, type, (void *) &tmp, sizeof(tmp));
 		}
+#ifdef PTP_STATS_ENABLED
+		case REMOTE_PTP_STATS:
+			return bt.sendDATA(id, type, (void *) PTP_Stats, sizeof(PTP_Stats));
+#endif
+		case REMOTE_TIMING_STATS:
+			return bt.sendDATA(id, type, (void *) &timer.timing, sizeof(timer.timing));
+		case REMOTE_ENERGY:
+			return bt.sendDATA(id, type, (void *) &energy.ledger, sizeof(energy.ledger));
+		case REMOTE_LINK_STATS:
+			return bt.sendDATA(id, type, (void *) &bt.stats, sizeof(bt.stats));
+		case REMOTE_CATALOG:
+		{
+			uint8_t packet[1 + REMOTE_CATALOG_BATCH * sizeof(remote_catalog_entry)];
+			for(uint8_t i = 0; i < MAX_STORED; i += REMOTE_CATALOG_BATCH)
+			{
+				uint8_t n = 1;
+				packet[0] = i;
+				for(uint8_t j = i; j < i + REMOTE_CATALOG_BATCH && j < MAX_STORED; j++)
+				{
+					remote_catalog_entry *entry = (remote_catalog_entry *) &packet[n];
+					eeprom_read_block((void*)entry->name, stored[j].Name, sizeof(entry->name));
+					entry->hash = timer.storedHash(j);
+					n += sizeof(remote_catalog_entry);
+				}
+				bt.sendDATA(id, type, (void *) packet, n);
+			}
+			return 0;
+		}
 		case REMOTE_THUMBNAIL:
 		{
 			menu.message(STR("Busy"));
@@ -185,7 +261,12 @@ void Remote::event()
 	{
 		case BT_EVENT_DISCONNECT:
 			notify.unWatch(&remote_notify); // stop all active notifications
+			notifyDelta = 0;
+			notifyPending = 0;
+			notifyAwaiting = 0;
+			memset(notifyDirty, 0, sizeof(notifyDirty));
 			//DEBUG(STR("REMOTE::EVENT: Disconnected\r\n"));
+			if(connected) notify.changed(WATCH_BT);
 			connected = 0;
 			nmx = 0;
 			break;
@@ -193,6 +274,7 @@ void Remote::event()
 		case BT_EVENT_CONNECT:
 			if(bt.state == BT_ST_CONNECTED)
 			{
+				if(!connected) notify.changed(WATCH_BT);
 				connected = 1;
 				//DEBUG(STR("REMOTE::EVENT: Connected\r\n"));
 				request(REMOTE_MODEL);
@@ -205,12 +287,26 @@ void Remote::event()
 			break;
 
 		case BT_EVENT_DATA:
+			if(bt.dataType == REMOTE_TYPE_NOTIFY_DELTA || bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH)
+			{
+				int8_t i = notifyIndex(bt.dataId);
+				if(i >= 0 && bt.dataType == REMOTE_TYPE_NOTIFY_DELTA)
+				{
+					notify.watch(notifyItems[i].id, notifyItems[i].watch, &remote_notify);
+					notifyDelta |= (1 << i);
+					notifyWhole |= (1 << i);
+					notifyPending |= (1 << i);
+					bt.event = BT_EVENT_NULL;
+					break;
+				}
+				if(i >= 0) notifyDelta &= ~(1 << i); // and on to the plain unwatch below
+			}
 			switch(bt.dataId)
 			{
 				case REMOTE_STATUS:
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
 					if(bt.dataType == REMOTE_TYPE_SEND && bt.dataSize == sizeof(timer_status)) memcpy(&status, bt.data, bt.dataSize);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_STATUS, (void *)&timer.status, sizeof(timer.status), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_STATUS, WATCH_STATUS, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_STATUS, &remote_notify);
 					break;
 				case REMOTE_PROGRAM:
@@ -219,29 +315,30 @@ void Remote::event()
 					if(bt.dataType == REMOTE_TYPE_SET && bt.dataSize == sizeof(program))
 					{
 						memcpy((void*)&timer.current, bt.data, bt.dataSize);
+						notify.changed(WATCH_PROGRAM);
 						menu.refresh();
 					}
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_PROGRAM, (void *)&timer.current, sizeof(timer.current), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_PROGRAM, WATCH_PROGRAM, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_PROGRAM, &remote_notify);
 					break;
 				case REMOTE_BATTERY:
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
 					if(bt.dataType == REMOTE_TYPE_SEND) memcpy(&battery, bt.data, bt.dataSize);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_BATTERY, (void *)&battery_percent, sizeof(battery_percent), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_BATTERY, WATCH_BATTERY, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_BATTERY, &remote_notify);
 					break;
 				case REMOTE_START:
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(timer.running ? REMOTE_START : REMOTE_STOP, REMOTE_TYPE_SEND);
 					if(bt.dataType == REMOTE_TYPE_SEND) running = 1;
 					if(bt.dataType == REMOTE_TYPE_SET) runHandler(FR_KEY, 1);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_START, (void *)&timer.running, sizeof(timer.running), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_START, WATCH_RUNNING, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_START, &remote_notify);
 					break;
 				case REMOTE_STOP:
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(timer.running ? REMOTE_START : REMOTE_STOP, REMOTE_TYPE_SEND);
 					if(bt.dataType == REMOTE_TYPE_SEND) running = 0;
 					if(bt.dataType == REMOTE_TYPE_SET) timerStop(FR_KEY, 1);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_START, (void *)&timer.running, sizeof(timer.running), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_START, WATCH_RUNNING, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_START, &remote_notify);
 					break;
 				case REMOTE_BULB_START:
@@ -259,17 +356,25 @@ void Remote::event()
 					break;
 				case REMOTE_FIRMWARE:
 				case REMOTE_BT_FW_VERSION:
+					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
+					break;
 				case REMOTE_PROTOCOL_VERSION:
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
+					if(bt.dataType == REMOTE_TYPE_SET && bt.dataSize == sizeof(uint8_t))
+					{
+						uint8_t framing = (uint8_t)bt.data[0] == BT_FRAMING_V2 ? BT_FRAMING_V2 : BT_FRAMING_V1;
+						bt.sendDATA(REMOTE_PROTOCOL_VERSION, REMOTE_TYPE_SET, (void *) &framing, sizeof(framing));
+						bt.setFraming(framing);
+					}
 					break;
 				case REMOTE_CAMERA_FPS:
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_CAMERA_FPS, (void *)&conf.camera.cameraFPS, sizeof(conf.camera.cameraFPS), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_CAMERA_FPS, WATCH_CAMERA_FPS, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_CAMERA_FPS, &remote_notify);
 					break;
 				case REMOTE_CAMERA_MAKE:
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_CAMERA_MAKE, (void *)&conf.camera.cameraMake, sizeof(conf.camera.cameraMake), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_CAMERA_MAKE, WATCH_CAMERA_MAKE, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_CAMERA_MAKE, &remote_notify);
 					break;
 				case REMOTE_DEBUG:
@@ -323,7 +428,7 @@ void Remote::event()
 						if(tmp) recording = true; else recording = false;
 					}
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_VIDEO, (void *)&camera.recording, sizeof(camera.recording), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_VIDEO, WATCH_VIDEO, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_VIDEO, &remote_notify);
 					break;
 				case REMOTE_LIVEVIEW:
@@ -340,9 +445,82 @@ void Remote::event()
 						if(tmp) modeLiveView = true; else modeLiveView = false;
 					}
 					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
-					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_LIVEVIEW, (void *)&camera.modeLiveView, sizeof(camera.modeLiveView), &remote_notify);
+					if(bt.dataType == REMOTE_TYPE_NOTIFY_WATCH) notify.watch(REMOTE_LIVEVIEW, WATCH_LIVEVIEW, &remote_notify);
 					if(bt.dataType == REMOTE_TYPE_NOTIFY_UNWATCH) notify.unWatch(REMOTE_LIVEVIEW, &remote_notify);
 					break;
+				case REMOTE_PTP_STATS:
+					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
+					if(bt.dataType == REMOTE_TYPE_SET) PTP_StatsReset();
+					break;
+				case REMOTE_TIMING_STATS:
+					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
+					if(bt.dataType == REMOTE_TYPE_SET) timer.resetTiming();
+					break;
+				case REMOTE_ENERGY:
+					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
+					if(bt.dataType == REMOTE_TYPE_SET) energy.reset();
+					break;
+				case REMOTE_LINK_STATS:
+					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
+					if(bt.dataType == REMOTE_TYPE_SET) bt.resetStats();
+					break;
+				case REMOTE_CATALOG:
+					if(bt.dataType == REMOTE_TYPE_REQUEST) send(bt.dataId, REMOTE_TYPE_SEND);
+					break;
+				case REMOTE_STORED:
+					if(bt.dataType == REMOTE_TYPE_REQUEST)
+					{
+						uint32_t slots = 0; // worked out first, bt.data doesn't survive sending
+						if(bt.dataSize == MAX_STORED * sizeof(uint16_t))
+						{
+							for(uint8_t i = 0; i < MAX_STORED; i++)
+							{
+								uint16_t hash = (uint8_t)bt.data[i * 2] | ((uint16_t)(uint8_t)bt.data[i * 2 + 1] << 8);
+								if(hash != timer.storedHash(i)) slots |= (uint32_t)1 << i;
+							}
+						}
+						else
+						{
+							for(uint8_t i = 0; i < bt.dataSize; i++)
+							{
+								if((uint8_t)bt.data[i] < MAX_STORED) slots |= (uint32_t)1 << (uint8_t)bt.data[i];
+							}
+						}
+						sendStored(slots);
+					}
+					if(bt.dataType == REMOTE_TYPE_SET && bt.dataSize > 0 && (uint8_t)bt.data[0] < MAX_STORED)
+					{
+						if(timer.running)
+						{
+							// writing a program blocks for ~330ms, too long between frames; the slot goes back as it is //
+							sendStored((uint32_t)1 << (uint8_t)bt.data[0]);
+						}
+						else if(bt.data[0] == 0 || (bt.dataSize > 1 && (uint8_t)bt.data[1] == 255))
+						{
+							// slot 0 is the DEFAULT program, and a free one (Name[0] == 255) makes the next boot run setDefault() over every slot //
+							sendStored((uint32_t)1 << (uint8_t)bt.data[0]);
+						}
+						else if(bt.dataSize == 1)
+						{
+							timer.store(bt.data[0], 0);
+						}
+						else if(bt.dataSize == 1 + sizeof(program))
+						{
+							program p;
+							memcpy((void*)&p, bt.data + 1, sizeof(program));
+							timer.store(bt.data[0], &p);
+						}
+						menu.refresh();
+					}
+					break;
+				case REMOTE_NOTIFY:
+					if(bt.dataType == REMOTE_TYPE_SET && bt.dataSize == sizeof(uint8_t) && notifyAwaiting && (uint8_t)bt.data[0] == notifySeq)
+					{
+						memset(notifyDirty, 0, sizeof(notifyDirty)); // the receiver has notifySent
+						notifyWhole &= ~notifyWholeSent;
+						notifyAwaiting = 0;
+					}
+					break;
 				default:
 					return;
 			}
@@ -352,8 +530,111 @@ void Remote::event()
 	requestActive = 0;
 }
 
+int8_t Remote::notifyIndex(uint8_t id)
+{
+	if(id == REMOTE_STOP) id = REMOTE_START;
+	for(uint8_t i = 0; i < REMOTE_NOTIFY_ITEMS; i++)
+	{
+		if(notifyItems[i].id == id) return i;
+	}
+	return -1;
+}
+
+#define DIRTY(x) (notifyDirty[(x) >> 3] & (1 << ((x) & 7)))
+
+// Sends the items changed since the last REMOTE_NOTIFY batch, all in one
+// packet, as runs covering every byte sent since the last acknowledged
+// batch: the receiver may have missed any batch after that one, and
+// applies the runs over whatever copy it has.  Scheduled every
+// REMOTE_NOTIFY_MS, which caps the rate.
+void Remote::notifyTask()
+{
+	static uint8_t buf[REMOTE_NOTIFY_BUF];
+
+	if(!notifyDelta) return;
+
+	if(notifyAwaiting && clock.Ms() - notifySentMs > REMOTE_NOTIFY_ACK_MS)
+	{
+		notifyPending |= notifyDelta; // not acknowledged; send the differences again
+		notifyAwaiting = 0;
+	}
+	if(!(notifyPending & notifyDelta)) return;
+	notifyPending = 0;
+
+	uint8_t n = 1;
+	for(uint8_t i = 0; i < REMOTE_NOTIFY_ITEMS; i++)
+	{
+		if(!(notifyDelta & (1 << i))) continue;
+
+		const remote_notify_item *item = &notifyItems[i];
+		const volatile uint8_t *data = (const volatile uint8_t *)item->data;
+		uint8_t *now = &notifySent[item->offset];
+		uint8_t *rec = &buf[n];
+		uint8_t len = 2, whole = notifyWhole & (1 << i);
+
+		for(uint8_t x = 0; x < item->size; x++)
+		{
+			uint8_t b = data[x];
+			if(b == now[x]) continue;
+			now[x] = b;
+			notifyDirty[(item->offset + x) >> 3] |= 1 << ((item->offset + x) & 7);
+		}
+		rec[0] = item->id;
+		rec[1] = 0;
+
+		for(uint8_t x = 0; x < item->size && !whole; x++)
+		{
+			if(!DIRTY(item->offset + x)) continue;
+
+			uint8_t end = x + 1;
+			for(uint8_t y = end; y < item->size && y - end < REMOTE_NOTIFY_GAP; y++)
+			{
+				if(DIRTY(item->offset + y)) end = y + 1;
+			}
+
+			if(len + (end - x) > item->size + 2) whole = 1; // runs would cost more than the whole item
+			else
+			{
+				rec[len++] = x;
+				rec[len++] = end - x;
+				memcpy(&rec[len], &now[x], end - x);
+				len += end - x;
+				rec[1]++;
+			}
+			x = end;
+		}
+
+		if(whole)
+		{
+			for(uint8_t x = 0; x < item->size; x++) notifyDirty[(item->offset + x) >> 3] |= 1 << ((item->offset + x) & 7);
+			rec[1] = 1;
+			rec[2] = 0;
+			rec[3] = item->size;
+			memcpy(&rec[4], now, item->size);
+			len = 4 + item->size;
+		}
+
+		if(rec[1]) n += len;
+	}
+
+	if(n == 1) return; // nothing sent since the last acknowledged batch, so the receiver has all of it
+
+	buf[0] = ++notifySeq;
+	notifyWholeSent = notifyWhole;
+	notifyAwaiting = 1;
+	notifySentMs = clock.Ms();
+	bt.sendDATA(REMOTE_NOTIFY, REMOTE_TYPE_SEND, (void *) buf, n);
+}
+
 void remote_notify(uint8_t id)
 {
+	int8_t i = remote.notifyIndex(id);
+	if(i >= 0 && (remote.notifyDelta & (1 << i)))
+	{
+		remote.notifyPending |= (1 << i); // goes out with the next batch
+		return;
+	}
+
 	switch(id)
 	{
 		case REMOTE_START:
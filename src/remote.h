@@ -1,4 +1,4 @@
-#define REMOTE_VERSION 20130509
+#define REMOTE_VERSION 20140601 // BT_FRAMING_V2 available
 
 #define REMOTE_STATUS 1
 #define REMOTE_PROGRAM 2
@@ -14,6 +14,8 @@
 #define REMOTE_FIRMWARE 11
 #define REMOTE_BT_FW_VERSION 12
 #define REMOTE_PROTOCOL_VERSION 13
+// Note: SET REMOTE_PROTOCOL_VERSION to a BT_FRAMING_* byte to switch framing; it's SET back,
+// still in the old framing, with the framing used from then on (until disconnected)
 #define REMOTE_CAMERA_FPS 14
 #define REMOTE_CAMERA_MAKE 15
 
@@ -30,11 +32,62 @@
 #define REMOTE_VIDEO 22
 #define REMOTE_LIVEVIEW 23
 
+#define REMOTE_PTP_STATS 24
+// Note: REMOTE_PTP_STATS is sent as PTP_OpStats_t[PTP_STATS_SLOTS] (empty without PTP_STATS_ENABLED); SET clears it
+
+#define REMOTE_TIMING_STATS 25
+// Note: REMOTE_TIMING_STATS is sent as timing_stats (start, bulb, dead); SET clears it
+
+#define REMOTE_ENERGY 26
+// Note: REMOTE_ENERGY is sent as energy_ledger; SET clears it
+
+#define REMOTE_NOTIFY 27
+// Note: REMOTE_NOTIFY is only sent, as a batch of the items watched with
+// REMOTE_TYPE_NOTIFY_DELTA: the batch number, then for each item that
+// changed its id, a run count and the runs (offset, length, bytes) to
+// write over the receiver's copy.  The first batch after watching an
+// item sends it whole (one run).  A batch is acknowledged by SETting
+// REMOTE_NOTIFY to its number; until then every batch carries all the
+// bytes sent since the last acknowledged one, so a lost batch is covered
+// by the next.  REMOTE_START's item is timer.running.
+
+#define REMOTE_LINK_STATS 28
+// Note: REMOTE_LINK_STATS is sent as bt_link_stats; SET clears it
+
+#define REMOTE_CATALOG 29
+// Note: REMOTE_CATALOG is sent as packets of the first slot number and up to REMOTE_CATALOG_BATCH
+// remote_catalog_entry, covering the saved programs (stored[0] to stored[MAX_STORED - 1])
+
+#define REMOTE_STORED 30
+// Note: REMOTE_STORED is sent as one packet per slot, the slot number then the program (just the
+// number if the slot is free), then REMOTE_STORED_END.  REQUEST it with a list of slot numbers, or
+// with the MAX_STORED hashes the remote has (uint16_t, PROGRAM_HASH_EMPTY for a free slot) to get
+// just the slots that differ.  SET it to a slot number and program to save one (only the number
+// to free the slot).  While a timer runs a SET is refused and the slot sent back unchanged; so is
+// any SET of slot 0 (the DEFAULT program) or of a program whose first name byte is 0xFF.
+#define REMOTE_STORED_END 0xFF
+
+#define REMOTE_CATALOG_BATCH 5
+
 #define REMOTE_TYPE_SEND 0
 #define REMOTE_TYPE_REQUEST 1
 #define REMOTE_TYPE_SET 2
 #define REMOTE_TYPE_NOTIFY_WATCH 3
 #define REMOTE_TYPE_NOTIFY_UNWATCH 4
+#define REMOTE_TYPE_NOTIFY_DELTA 5 // watch, with changes batched into REMOTE_NOTIFY
+
+#define REMOTE_NOTIFY_MS 250       // at most one REMOTE_NOTIFY batch this often
+#define REMOTE_NOTIFY_ACK_MS 2000  // send again what hasn't been acknowledged after this
+#define REMOTE_NOTIFY_GAP 2        // unchanged bytes a run spans rather than starting a new one
+#define REMOTE_NOTIFY_ITEMS 8
+#define REMOTE_NOTIFY_COPY (sizeof(timer_status) + sizeof(program) + 6)
+#define REMOTE_NOTIFY_BUF (1 + REMOTE_NOTIFY_ITEMS * 4 + REMOTE_NOTIFY_COPY)
+
+struct remote_catalog_entry
+{
+    char name[12];
+    uint16_t hash; // shutter::storedHash
+};
 
 #define REMOTE_MODEL_TLP 1
 #define REMOTE_MODEL_IPHONE 2
@@ -51,6 +104,8 @@ public:
     uint8_t unWatch(uint8_t id);
     static uint8_t send(uint8_t id, uint8_t type);
     void event(void);
+    void notifyTask(void);
+    int8_t notifyIndex(uint8_t id);
 
     uint8_t connected;
     uint8_t nmx;
@@ -64,8 +119,19 @@ public:
 
     uint8_t model;
 
+    uint8_t notifyDelta;    // items watched with REMOTE_TYPE_NOTIFY_DELTA, by bit
+    uint8_t notifyPending;  // changed since the last batch
+
 private:
 	volatile uint8_t requestActive;
+
+    uint8_t notifyWhole;    // to send whole: the receiver has no copy yet
+    uint8_t notifyWholeSent;
+    uint8_t notifySeq;
+    uint8_t notifyAwaiting; // last batch not acknowledged yet
+    uint32_t notifySentMs;
+    uint8_t notifySent[REMOTE_NOTIFY_COPY];  // what the receiver has once the last batch arrives
+    uint8_t notifyDirty[(REMOTE_NOTIFY_COPY + 7) / 8]; // bytes sent since the last acknowledged batch, by bit
 };
 
 void remote_notify(uint8_t id);
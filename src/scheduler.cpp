@@ -0,0 +1,192 @@
+/*
+ *  scheduler.cpp
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <string.h>
+#include "clock.h"
+#include "scheduler.h"
+
+extern Clock clock;
+
+/******************************************************************
+ *
+ *   Scheduler Class
+ *   Cooperative main loop tasks with priority, period and deadline
+ *
+ ******************************************************************/
+
+Scheduler::Scheduler()
+{
+    count = 0;
+    passes = 0;
+}
+
+/******************************************************************
+ *
+ *   Scheduler::add
+ *   Tasks of the same priority run in the order they were added.
+ *   Returns 0 if the table is full.
+ *
+ ******************************************************************/
+
+uint8_t Scheduler::add(void (*func)(), const char *name, uint8_t priority, uint16_t period, uint16_t deadline)
+{
+    if(count >= SCHED_TASKS) return 0;
+
+    sched_task_t *t = &tasks[count];
+
+    memset(t, 0, sizeof(sched_task_t));
+    t->func = func;
+    t->name = name;
+    t->priority = priority;
+    t->period = period;
+    t->deadline = deadline;
+    t->due = clock.Ms() + period;
+
+    count++;
+    return 1;
+}
+
+/******************************************************************
+ *
+ *   Scheduler::run
+ *   One main loop pass: runs every task that's due, most urgent
+ *   first.  Critical every-pass tasks get another turn after each
+ *   lower task, so a slow redraw delays the shutter by one task
+ *   at most rather than the whole pass.
+ *
+ ******************************************************************/
+
+void Scheduler::run()
+{
+    uint8_t i;
+    int8_t n;
+    uint32_t now = clock.Ms();
+
+    for(i = 0; i < count; i++) tasks[i].ran = 0;
+
+    while((n = next(now)) >= 0)
+    {
+        exec(&tasks[n], now);
+
+        if(tasks[n].priority != SCHED_CRITICAL)
+        {
+            for(i = 0; i < count; i++)
+            {
+                if(tasks[i].priority == SCHED_CRITICAL && tasks[i].period == 0) tasks[i].ran = 0;
+            }
+        }
+
+        now = clock.Ms();
+    }
+
+    for(i = 0; i < count; i++) // so the idle sleep ends in time for the next periodic task
+    {
+        if(tasks[i].period) clock.wakeAt(tasks[i].due);
+    }
+
+    passes++;
+}
+
+/******************************************************************
+ *
+ *   Scheduler::next
+ *   Index of the most urgent task waiting to run, -1 if none
+ *
+ ******************************************************************/
+
+int8_t Scheduler::next(uint32_t now)
+{
+    int8_t best = -1;
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        sched_task_t *t = &tasks[i];
+
+        if(t->ran) continue;
+        if(t->period && (int32_t)(now - t->due) < 0) continue;
+        if(best < 0 || t->priority < tasks[best].priority) best = i;
+    }
+
+    return best;
+}
+
+/******************************************************************
+ *
+ *   Scheduler::exec
+ *   Runs a task and updates its accounting.  Run time comes from
+ *   Timer3 (1us) unless it took long enough for that to wrap.
+ *   Every pass tasks are late by the time since they last started
+ *   or since the main loop woke, whichever is later.
+ *
+ ******************************************************************/
+
+void Scheduler::exec(sched_task_t *t, uint32_t now)
+{
+    uint32_t late, since, ms, us;
+    uint16_t startTicks, endTicks;
+    uint8_t sreg;
+
+    since = t->due;
+    if(t->period == 0 && (int32_t)(clock.idleEndMs - since) > 0) since = clock.idleEndMs; // the idle sleep isn't lateness
+    late = (t->period || t->runs) ? now - since : 0;
+    if(t->period) // next run on the period grid, without bursts to catch up
+    {
+        t->due += t->period;
+        if((int32_t)(now - t->due) >= 0) t->due = now + t->period;
+    }
+    else
+    {
+        t->due = now;
+    }
+    t->ran = 1;
+
+    sreg = SREG;
+    cli();
+    startTicks = TCNT3;
+    SREG = sreg;
+
+    t->func();
+
+    ms = clock.Ms() - now;
+    sreg = SREG;
+    cli();
+    endTicks = TCNT3;
+    SREG = sreg;
+
+    us = ms > 60 ? ms * 1000 : (uint16_t)(endTicks - startTicks);
+
+    t->runs++;
+    t->timeTotal += us;
+    if(us > t->timeMax) t->timeMax = us;
+    if(late > t->lateMax) t->lateMax = late > 0xFFFF ? 0xFFFF : (uint16_t)late;
+    if(t->deadline && late > t->deadline) t->overruns++;
+}
+
+/******************************************************************
+ *
+ *   Scheduler::resetStats
+ *
+ *
+ ******************************************************************/
+
+void Scheduler::resetStats()
+{
+    for(uint8_t i = 0; i < count; i++)
+    {
+        tasks[i].runs = 0;
+        tasks[i].overruns = 0;
+        tasks[i].lateMax = 0;
+        tasks[i].timeTotal = 0;
+        tasks[i].timeMax = 0;
+    }
+    passes = 0;
+}
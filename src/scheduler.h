@@ -0,0 +1,50 @@
+/*
+ *  scheduler.h
+ *  Timelapse+
+ *
+ *  Created by Elijah Parker
+ *  Copyright 2012 Timelapse+
+ *  Licensed under GPLv3
+ *
+ */
+
+#define SCHED_TASKS 16
+
+// Priorities, lowest runs first //
+#define SCHED_CRITICAL 0    // shutter timing -- gets another turn after every lower task
+#define SCHED_NORMAL 1      // I/O that shouldn't starve: USB, BT, camera events
+#define SCHED_BEST_EFFORT 2 // UI and notifications
+
+struct sched_task_t
+{
+    void (*func)();
+    const char *name;   // PSTR
+    uint8_t priority;
+    uint16_t period;    // ms between runs, 0 to run every pass
+    uint16_t deadline;  // ms it may start late before it counts as an overrun, 0 for none
+    uint32_t due;       // Ms() it's due (every pass tasks: when it last started)
+    uint8_t ran;        // has had its turn this pass
+
+    uint32_t runs;
+    uint16_t overruns;
+    uint16_t lateMax;   // ms
+    uint32_t timeTotal; // us
+    uint32_t timeMax;   // us
+};
+
+class Scheduler
+{
+public:
+    Scheduler();
+    uint8_t add(void (*func)(), const char *name, uint8_t priority, uint16_t period, uint16_t deadline);
+    void run();
+    void resetStats();
+
+    sched_task_t tasks[SCHED_TASKS];
+    uint8_t count;
+    uint32_t passes;
+
+private:
+    int8_t next(uint32_t now);
+    void exec(sched_task_t *t, uint32_t now);
+};
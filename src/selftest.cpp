@@ -116,11 +116,13 @@ int8_t test()
                    }
                    
                    lcd.update();
+                   lcd.wait(); // no scheduler here to run a deferred swap
                    break;
 
                case 'c':
                    lcd.cls();
                    lcd.update();
+                   lcd.wait();
                    break;
 
                case 'T':
@@ -365,6 +367,7 @@ int8_t run_tests()
         }
         
         lcd.update();
+        lcd.wait();
         pass &= test_assert(button.waitfor(DOWN_KEY));
     }
     
@@ -374,6 +377,7 @@ int8_t run_tests()
     {
         lcd.cls();
         lcd.update();
+        lcd.wait();
         pass &= test_assert(button.waitfor(DOWN_KEY));
     }
     
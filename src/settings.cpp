@@ -10,6 +10,7 @@
  
 #include <avr/eeprom.h>
 #include <string.h>
+#include <stddef.h>
 #include "settings.h"
 #include "5110LCD.h"
 #include "IR.h"
@@ -18,9 +19,14 @@
 #include "remote.h"
 #include "timelapseplus.h"
 #include "tlp_menu_functions.h"
+#include "notify.h"
 
 settings_t conf_eep EEMEM;
 camera_settings_t camera_settings_eep[MAX_CAMERAS_SETTINGS] EEMEM; 
+// The journal sits in the last SETTINGS_LOG_SIZE bytes of EEPROM rather than in .eeprom, so the
+// EEMEM objects linked after settings.o (light_test_results) keep the addresses older firmware gave them //
+#define settings_log_eep ((uint8_t*)(E2END + 1 - SETTINGS_LOG_SIZE))
+
 volatile settings_t conf;
 uint8_t settings_reset = 0;
 uint8_t settings_camera_index = 0;
@@ -30,26 +36,157 @@ extern IR ir;
 extern Remote remote;
 extern shutter timer;
 extern BT bt;
+extern Notify notify;
 
 /******************************************************************
  *
- *   settings_save
+ *   settings_log_replay
+ *   Applies the journal records that fall in offset..offset+size to
+ *   dst; returns where the next record goes, or 0 if there's no
+ *   journal (SETTINGS_LOG_MAGIC missing, as after an upgrade from
+ *   firmware without one).  Stops at the first free (0xFF) or
+ *   damaged record.
+ *
+ ******************************************************************/
+
+static uint8_t settings_log_replay(uint8_t *dst, uint8_t offset, uint8_t size)
+{
+    uint8_t pos = 1;
+
+    if(eeprom_read_byte(&settings_log_eep[0]) != SETTINGS_LOG_MAGIC) return 0;
+
+    while(pos + SETTINGS_LOG_HEADER <= SETTINGS_LOG_SIZE)
+    {
+        uint8_t at = eeprom_read_byte(&settings_log_eep[pos]);
+        uint8_t len = eeprom_read_byte(&settings_log_eep[pos + 1]);
+        uint8_t sum = at + len;
+        uint8_t *data = &settings_log_eep[pos + SETTINGS_LOG_HEADER];
+
+        if(at == 0xFF || len == 0 || at + len > (int)sizeof(settings_t) || pos + SETTINGS_LOG_HEADER + len > SETTINGS_LOG_SIZE) break;
+
+        for(uint8_t i = 0; i < len; i++) sum += eeprom_read_byte(data + i);
+        if((uint8_t)~sum != eeprom_read_byte(&settings_log_eep[pos + 2])) break;
+
+        for(uint8_t i = 0; i < len; i++)
+        {
+            if(at + i >= offset && at + i < offset + size) dst[at + i - offset] = eeprom_read_byte(data + i);
+        }
+
+        pos += SETTINGS_LOG_HEADER + len;
+    }
+
+    return pos;
+}
+
+/******************************************************************
+ *
+ *   settings_read
+ *   Reads part of the saved settings_t (conf_eep with the journal
+ *   applied)
+ *
+ ******************************************************************/
+
+void settings_read(void *dst, uint8_t offset, uint8_t size)
+{
+    eeprom_read_block(dst, (uint8_t*)&conf_eep + offset, size);
+    settings_log_replay((uint8_t*)dst, offset, size);
+}
+
+/******************************************************************
+ *
+ *   settings_compact
+ *   Writes conf into conf_eep (just the bytes that differ) and
+ *   empties the journal, first byte first so a cut-off compaction
+ *   loses no more than the change being saved, then marks it with
+ *   SETTINGS_LOG_MAGIC
+ *
+ ******************************************************************/
+
+static void settings_compact()
+{
+    eeprom_update_block((const void*)&conf, &conf_eep, sizeof(settings_t));
+    for(uint8_t i = 0; i < SETTINGS_LOG_SIZE; i++) eeprom_update_byte(&settings_log_eep[i], 0xFF);
+    eeprom_write_byte(&settings_log_eep[0], SETTINGS_LOG_MAGIC);
+}
+
+/******************************************************************
+ *
+ *   settings_log_append
+ *   Adds a record of len bytes of conf at offset; the offset byte is
+ *   written last, so a record cut off by a reset is never replayed
+ *
+ ******************************************************************/
+
+static uint8_t settings_log_append(uint8_t pos, uint8_t offset, uint8_t len)
+{
+    uint8_t *src = (uint8_t*)&conf + offset;
+    uint8_t sum = offset + len;
+
+    for(uint8_t i = 0; i < len; i++) sum += src[i];
+
+    eeprom_update_byte(&settings_log_eep[pos + 1], len);
+    eeprom_update_byte(&settings_log_eep[pos + 2], ~sum);
+    eeprom_update_block((const void*)src, &settings_log_eep[pos + SETTINGS_LOG_HEADER], len);
+    if(pos + SETTINGS_LOG_HEADER + len < SETTINGS_LOG_SIZE) eeprom_update_byte(&settings_log_eep[pos + SETTINGS_LOG_HEADER + len], 0xFF);
+    eeprom_write_byte(&settings_log_eep[pos], offset);
+
+    return pos + SETTINGS_LOG_HEADER + len;
+}
+
+/******************************************************************
  *
+ *   settings_save
+ *   Appends what changed in conf to the journal as (offset, bytes)
+ *   records, a few EEPROM bytes per save instead of all of conf_eep.
+ *   Once the journal is full, conf is written into conf_eep and the
+ *   journal starts over, so records wear the whole journal evenly
+ *   and conf_eep only sees one write per fill.  Without a journal
+ *   (after an upgrade) the first change compacts, as if it were full.
  *
  ******************************************************************/
 
 void settings_save()
 {
+    settings_t saved;
+    uint8_t *now = (uint8_t*)&conf, *was = (uint8_t*)&saved;
+
     if(conf.camera.cameraMake == PANASONIC) conf.camera.halfPress = HALF_PRESS_DISABLED;
+
+    eeprom_read_block((void*)&saved, &conf_eep, sizeof(settings_t));
+    uint8_t pos = settings_log_replay(was, 0, sizeof(settings_t));
+    if(!pos) pos = SETTINGS_LOG_SIZE; // no journal: the first change compacts, which starts one
+
     if(settings_camera_index > 0)
     {
-        eeprom_write_block((const void*)&conf.camera, &camera_settings_eep[settings_camera_index - 1], sizeof(camera_settings_t));
-        eeprom_read_block((void*)&conf.camera, &conf_eep.camera, sizeof(camera_settings_t));
+        eeprom_update_block((const void*)&conf.camera, &camera_settings_eep[settings_camera_index - 1], sizeof(camera_settings_t));
+        memcpy((void*)&conf.camera, &saved.camera, sizeof(camera_settings_t));
     }
     conf.camera.autoConfigured = 0;
-    eeprom_write_block((const void*)&conf, &conf_eep, sizeof(settings_t));
-    lcd.init(conf.lcdContrast);
-    lcd.update();
+
+    for(uint8_t x = 0; x < sizeof(settings_t); x++)
+    {
+        if(now[x] == was[x]) continue;
+
+        uint8_t end = x + 1;
+        for(uint8_t y = end; y < sizeof(settings_t) && y - end < SETTINGS_LOG_GAP; y++)
+        {
+            if(now[y] != was[y]) end = y + 1;
+        }
+
+        if(pos + SETTINGS_LOG_HEADER + (end - x) > SETTINGS_LOG_SIZE)
+        {
+            settings_compact();
+            break;
+        }
+        pos = settings_log_append(pos, x, end - x);
+        x = end;
+    }
+
+    if(conf.lcdContrast != saved.lcdContrast)
+    {
+        lcd.init(conf.lcdContrast);
+        lcd.update();
+    }
 }
 
 /******************************************************************
@@ -61,7 +198,9 @@ void settings_save()
 
 void settings_load()
 {
-    eeprom_read_block((void*)&conf, &conf_eep, sizeof(settings_t));
+    uint8_t fps = conf.camera.cameraFPS, make = conf.camera.cameraMake;
+
+    settings_read((void*)&conf, 0, sizeof(settings_t));
     if(settings_camera_index > 0)
     {
         eeprom_read_block((void*)&conf.camera, &camera_settings_eep[settings_camera_index - 1], sizeof(camera_settings_t));
@@ -77,6 +216,8 @@ void settings_load()
     lcd.color(conf.lcdColor);
     ir.init();
     ir.make = conf.camera.cameraMake;
+    if(conf.camera.cameraFPS != fps) notify.changed(WATCH_CAMERA_FPS);
+    if(conf.camera.cameraMake != make) notify.changed(WATCH_CAMERA_MAKE);
     if(conf.auxPort != AUX_MODE_DISABLED)
     {
         aux1_off();
@@ -166,6 +307,7 @@ void settings_default()
         eeprom_write_block((const void*)&cs, &camera_settings_eep[i], sizeof(camera_settings_t));
     }
     settings_save();
+    settings_compact(); // also clears out a journal left from older firmware
     settings_load();
 }
 
@@ -229,7 +371,7 @@ void settings_setup_camera_index(char *serial)
         }
     }
 
-    eeprom_read_block((void*)&cs, &conf_eep.camera, sizeof(camera_settings_t));
+    settings_read((void*)&cs, offsetof(settings_t, camera), sizeof(camera_settings_t));
     strncpy(cs.cameraSerial, serial, 22);
     eeprom_write_block((const void*)&cs, &camera_settings_eep[last_empty_index], sizeof(camera_settings_t));
     settings_load_camera_index(last_empty_index);
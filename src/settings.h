@@ -60,6 +60,12 @@
 
 #define MAX_CAMERAS_SETTINGS 5
 
+// Settings journal: conf_eep plus the records in settings_log_eep, see settings_save
+#define SETTINGS_LOG_SIZE 128
+#define SETTINGS_LOG_MAGIC 0xA5 // first byte of a journal in this format; anything else there is left from older firmware
+#define SETTINGS_LOG_HEADER 3  // offset, length, check
+#define SETTINGS_LOG_GAP 2     // unchanged bytes a record spans rather than starting another
+
 struct camera_settings_t
 {
     char cameraName[13];
@@ -126,6 +132,8 @@ void settings_default(void);
 void settings_update(void);
 void settings_init(void);
 
+void settings_read(void *dst, uint8_t offset, uint8_t size);
+
 void settings_load_camera_default(void);
 void settings_load_camera_index(uint8_t index);
 void settings_setup_camera_index(char *serial);
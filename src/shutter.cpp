@@ -17,6 +17,7 @@
 #include <avr/version.h>
 #include <avr/eeprom.h>
 #include <string.h>
+#include <util/crc16.h>
 
 #include "tldefs.h"
 #include "shutter.h"
@@ -34,6 +35,7 @@
 #include "5110LCD.h"
 #include "button.h"
 #include "Menu.h"
+#include "notify.h"
 
 #define RUN_DELAY 0
 #define RUN_BULB 1
@@ -52,12 +54,14 @@ extern Clock clock;
 extern Light light;
 extern MENU menu;
 extern LCD lcd;
+extern Notify notify;
 extern Button button;
 
 volatile unsigned char state;
 const uint16_t settings_warn_time = 0;
 const uint16_t settings_mirror_up_time = 3;
 volatile char cable_connected; // 1 = cable connected, 0 = disconnected
+uint8_t check_cable_timer;
 
 char shutter_state, ir_shutter_state; // used only for momentary toggle mode //
 uint32_t BulbMax; // calculated during bulb ramp mode
@@ -143,6 +147,7 @@ void shutter::setDefault()
     }
 
     saveCurrent();
+    notify.changed(WATCH_PROGRAM);
 }
 
 /******************************************************************
@@ -163,7 +168,8 @@ void shutter_off(void)
     
     SHUTTER_CLOSE;
     MIRROR_DOWN; 
-    clock.in(20, &check_cable);
+    clock.cancel(check_cable_timer); // one pending check is enough
+    check_cable_timer = clock.in(20, &check_cable);
     ir_shutter_state = 0;
     shutter_state = 0;
 }
@@ -190,7 +196,7 @@ void shutter_half(void)
 {
     shutter_off(); // first we completely release the shutter button since some cameras need this to release the bulb
 
-    if(conf.camera.halfPress == HALF_PRESS_ENABLED) clock.in(30, &shutter_half_delayed);
+    if(conf.camera.halfPress == HALF_PRESS_ENABLED) clock.in(30, &shutter_half_delayed, CLOCK_TIMER_ISR);
 }
 void shutter_half_delayed(void)
 {
@@ -265,9 +271,9 @@ void shutter_bulbStart(void)
             shutter_full();
             shutter_state = 1;
             if(camera.ready)
-                clock.in(SHUTTER_PRESS_TIME, &shutter_off);
+                clock.in(SHUTTER_PRESS_TIME, &shutter_off, CLOCK_TIMER_ISR);
             else
-                clock.in(SHUTTER_PRESS_TIME, &shutter_half);
+                clock.in(SHUTTER_PRESS_TIME, &shutter_half, CLOCK_TIMER_ISR);
         }
     }
 }
@@ -311,7 +317,7 @@ void shutter_bulbEnd(void)
         {
             shutter_full();
             shutter_state = 0;
-            clock.in(SHUTTER_PRESS_TIME, &shutter_off);
+            clock.in(SHUTTER_PRESS_TIME, &shutter_off, CLOCK_TIMER_ISR);
         }
     }
     DEBUG_NL();
@@ -334,7 +340,7 @@ void shutter_capture(void)
     if(conf.camera.interface & (INTERFACE_CABLE | INTERFACE_USB))
     {
         shutter_full();
-        clock.in(SHUTTER_PRESS_TIME, &shutter_off);
+        clock.in(SHUTTER_PRESS_TIME, &shutter_off, CLOCK_TIMER_ISR);
         ir_shutter_state = 0;
         shutter_state = 0;
         if(cable_connected == 0)
@@ -395,6 +401,7 @@ void shutter::saveCurrent()
 void shutter::restoreCurrent()
 {
     eeprom_read_block((void*)&current, &stored[MAX_STORED], sizeof(program));
+    notify.changed(WATCH_PROGRAM);
 }
 
 /******************************************************************
@@ -408,6 +415,7 @@ void shutter::load(char id)
 {
     eeprom_read_block((void*)&current, &stored[(uint8_t)id], sizeof(program));
     currentId = id;
+    notify.changed(WATCH_PROGRAM);
 }
 
 /******************************************************************
@@ -431,6 +439,54 @@ int8_t shutter::nextId(void)
     return id;
 }
 
+/******************************************************************
+ *
+ *   shutter::storedHash
+ *   CRC-16 of a saved program, PROGRAM_HASH_EMPTY if the slot is free
+ *
+ ******************************************************************/
+
+uint16_t shutter::storedHash(char id)
+{
+    program p;
+
+    eeprom_read_block((void*)&p, &stored[(uint8_t)id], sizeof(program));
+    if((uint8_t)p.Name[0] == 255) return PROGRAM_HASH_EMPTY;
+
+    return program_hash(&p);
+}
+
+/******************************************************************
+ *
+ *   shutter::store
+ *   Writes a program into a slot (or frees it if p is 0), skipping
+ *   the write when the slot holds it already; 1 if it changed
+ *
+ ******************************************************************/
+
+uint8_t shutter::store(char id, program *p)
+{
+    if(p == 0)
+    {
+        if(storedHash(id) == PROGRAM_HASH_EMPTY) return 0;
+        eeprom_write_byte((uint8_t*)&stored[(uint8_t)id].Name[0], 255);
+        return 1;
+    }
+
+    if(storedHash(id) == program_hash(p)) return 0;
+    eeprom_write_block((const void*)p, &stored[(uint8_t)id], sizeof(program));
+    return 1;
+}
+
+uint16_t program_hash(program *p)
+{
+    uint16_t crc = 0xFFFF;
+
+    for(uint8_t i = 0; i < sizeof(program); i++) crc = _crc_ccitt_update(crc, ((uint8_t*)p)[i]);
+
+    return crc == PROGRAM_HASH_EMPTY ? 1 : crc;
+}
+
 /******************************************************************
  *
  *   shutter::begin
@@ -442,6 +498,7 @@ void shutter::begin()
 {
     saveCurrent();
     running = 1;
+    notify.changed(WATCH_RUNNING);
 }
 
 /******************************************************************
@@ -504,9 +561,17 @@ char shutter::task()
         {
             uint32_t tmp = (uint32_t)current.Duration * 10 * 60;  //J.R.
             tmp /= (uint32_t) current.Gap;
-            current.Photos = (uint16_t) tmp;
+            if(current.Photos != (uint16_t) tmp)
+            {
+                current.Photos = (uint16_t) tmp;
+                notify.changed(WATCH_PROGRAM);
+            }
+        }
+        if(status.interval != current.Gap)
+        {
+            status.interval = current.Gap;
+            notify.changed(WATCH_STATUS);
         }
-        status.interval = current.Gap;
 
         usingUSB = camera.ready;
 
@@ -526,7 +591,11 @@ char shutter::task()
             menu.blink();
         }
 
-        if(status.preChecked == 0) status.preChecked = 1;
+        if(status.preChecked == 0)
+        {
+            status.preChecked = 1;
+            notify.changed(WATCH_STATUS);
+        }
         if(menu.waitingAlert()) return CONTINUE; //////////////////////////////////////////////
 
         if(status.preChecked == 1)
@@ -573,11 +642,13 @@ char shutter::task()
                 //    status.lightStart = status.nightTarget;
                 //}
                 status.preChecked = 2;
+                notify.changed(WATCH_STATUS);
             }
             
             if(!current.Mode & RAMP || current.nightMode == BRAMP_TARGET_AUTO || current.brampMethod != BRAMP_METHOD_AUTO)
             {
                 status.preChecked = 3;
+                notify.changed(WATCH_STATUS);
             }
 
             if(camera.supports.aperture) aperture = camera.aperture();
@@ -601,9 +672,15 @@ char shutter::task()
         status.photosRemaining = current.Photos;
         status.photosTaken = 0;
         status.mode = (uint8_t) current.Mode;
+        notify.changed(WATCH_STATUS);
+        notify.changed(WATCH_PROGRAM);
         last_photo_end_ms = 0;
         last_photo_ms = 0;
         evShift = 0;
+        nextReady = 0;
+        frame_scheduled_ms = 0;
+        frame_close_ms = 0;
+        resetTiming();
 
         ENABLE_MIRROR;
         ENABLE_SHUTTER;
@@ -624,6 +701,7 @@ char shutter::task()
             apertureEvShift = 0;
             aperturePausedStart = 0;
             apertureReady = 0;
+            notify.changed(WATCH_STATUS);
         }
         else
         {
@@ -694,6 +772,9 @@ char shutter::task()
     }
     if(pausing && run_state != RUN_BULB)
     {
+        nextReady = 0; // the exposure will shift with the aperture
+        frame_scheduled_ms = 0;
+        frame_close_ms = 0;
         apertureReady = 0;
         pausing = 0;
         paused = 1;
@@ -719,21 +800,30 @@ char shutter::task()
                 DEBUG_NL();
             }
             strcpy((char *) status.textStatus, TEXT("Delay"));
+            notify.changed(WATCH_STATUS);
             old_state = run_state;
         }
 
 
-        if(((unsigned long)clock.event_ms / 1000) > current.Delay)
+        if((clock.eventMs() / 1000) > current.Delay)
         {
             clock.tare();
             clock.reset();
             last_photo_ms = 0;
+            frame_scheduled_ms = 0;
+            frame_close_ms = 0;
             run_state = RUN_PHOTO;
         } 
         else
         {
-            status.nextPhoto = (unsigned int) (current.Delay - (unsigned long)clock.event_ms / 1000);
-            if(((unsigned long)clock.event_ms / 1000) + settings_mirror_up_time >= current.Delay)
+            clock.wakeAt(clock.Ms() + ((uint32_t)current.Delay + 1) * 1000 - clock.eventMs());
+            unsigned int next = (unsigned int) (current.Delay - clock.eventMs() / 1000);
+            if(status.nextPhoto != next)
+            {
+                status.nextPhoto = next;
+                notify.changed(WATCH_STATUS);
+            }
+            if((clock.eventMs() / 1000) + settings_mirror_up_time >= current.Delay)
             {
                 // Mirror Up //
                 shutter_half(); // This is to wake up the camera (even if USB is connected)
@@ -741,7 +831,7 @@ char shutter::task()
                 if(usbPrimary) shutter_off();
             }
 
-            if((settings_warn_time > 0) && (((unsigned long)clock.event_ms / 1000) + settings_warn_time >= current.Delay))
+            if((settings_warn_time > 0) && ((clock.eventMs() / 1000) + settings_warn_time >= current.Delay))
             {
                 // Flash Light //
                 _delay_ms(50);
@@ -760,6 +850,7 @@ char shutter::task()
                 DEBUG_NL();
             }
             strcpy((char *) status.textStatus, TEXT("Photo"));
+            notify.changed(WATCH_STATUS);
             old_state = run_state;
         }
         if(current.Exp > 0 || (current.Mode & RAMP) || conf.arbitraryBulb)
@@ -769,8 +860,10 @@ char shutter::task()
         } 
         else
         {
-            exps++;
+            frame_open_ms = clock.Ms();
             capture();
+            frameTiming(exps == 0, frame_open_ms, clock.Ms());
+            exps++;
             
             if(status.interval <= settings_mirror_up_time && !camera.ready) 
                 shutter_half(); // Mirror Up //
@@ -781,367 +874,28 @@ char shutter::task()
     
     if(run_state == RUN_BULB)
     {
-        static uint32_t bulb_length, exp;
-        static uint8_t m = SHUTTER_MODE_BULB;
-
         if(old_state != run_state)
         {
             old_state = run_state;
 
-            if(conf.debugEnabled)
-            {
-                DEBUG(PSTR("State: RUN_BULB"));
-                DEBUG_NL();
-            }
             strcpy((char *) status.textStatus, TEXT("Bulb"));
+            notify.changed(WATCH_STATUS);
 
-            m = camera.shutterType(current.Exp);
-            if(m & SHUTTER_MODE_BULB || conf.arbitraryBulb)
+            // Normally already done during the gap; still needed for the first
+            // frame, the remaining HDR brackets and after a pause
+            if(!nextReady && prepareExposure(exps, clock.Seconds()))
             {
-                if(conf.arbitraryBulb)
-                {
-                    exp = current.ArbExp * 100;
-                    m = SHUTTER_MODE_BULB;
-                }
-                else
-                {
-                    exp = camera.bulbTime((int8_t)current.Exp);
-                }
+                run_state = RUN_ERROR;
+                return CONTINUE;
             }
 
-            if(current.Mode & RAMP)
-            {
-                float key1 = 1, key2 = 1, key3 = 1, key4 = 1;
-                char found = 0;
-                uint8_t i;
-                m = SHUTTER_MODE_BULB;
-                shutter_off();
-
-
-                if(current.brampMethod == BRAMP_METHOD_KEYFRAME) //////////////////////////////// KEYFRAME RAMP /////////////////////////////////////
-                {
-                    // Bulb ramp algorithm goes here
-                    for(i = 0; i < current.Keyframes; i++)
-                    {
-                        if(clock.Seconds() <= current.Key[i])
-                        {
-                            found = 1;
-                            if(i == 0)
-                            {
-                                key2 = key1 = (float)(current.BulbStart);
-                            }
-                            else if(i == 1)
-                            {
-                                key1 = (float)(current.BulbStart);
-                                key2 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i - 1]));
-                            }
-                            else
-                            {
-                                key1 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i - 2]));
-                                key2 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i - 1]));
-                            }
-                            key3 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i]));
-                            key4 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i < (current.Keyframes - 1) ? i + 1 : i]));
-                            break;
-                        }
-                    }
-                    
-                    if(found)
-                    {
-                        uint32_t var1 = clock.Seconds();
-                        uint32_t var2 = (i > 0 ? current.Key[i - 1] : 0);
-                        uint32_t var3 = current.Key[i];
-
-                        float t = (float)(var1 - var2) / (float)(var3 - var2);
-                        float curveEv = curve(key1, key2, key3, key4, t);
-                        status.rampStops = (float)current.BulbStart - curveEv;
-                        exp = camera.bulbTime(curveEv - (float)evShift);
-
-                        if(conf.debugEnabled)
-                        {
-                            DEBUG(PSTR("   Keyframe: "));
-                            DEBUG(i);
-                            DEBUG_NL();
-                            DEBUG(PSTR("    Percent: "));
-                            DEBUG(t);
-                            DEBUG_NL();
-                            DEBUG(PSTR("    CurveEv: "));
-                            DEBUG(curveEv);
-                            DEBUG_NL();
-                            DEBUG(PSTR("CorrectedEv: "));
-                            DEBUG(curveEv - (float)evShift);
-                            DEBUG_NL();
-                            DEBUG(PSTR("   Exp (ms): "));
-                            DEBUG(exp);
-                            DEBUG_NL();
-                            DEBUG(PSTR("    evShift: "));
-                            DEBUG(evShift);
-                            DEBUG_NL();
-                        }
-                    }
-                    else
-                    {
-                        status.rampStops = (float)((int8_t)(current.BulbStart - (current.BulbStart - *((int8_t*)&current.Bulb[current.Keyframes - 1]))));
-                        exp = camera.bulbTime((int8_t)(current.BulbStart - *((int8_t*)&current.Bulb[current.Keyframes - 1]) - (float)evShift));
-                    }
-                }
-
-                else if(current.brampMethod == BRAMP_METHOD_GUIDED || current.brampMethod == BRAMP_METHOD_AUTO) //////////////////////////////// GUIDED / AUTO RAMP /////////////////////////////////////
-                {
-
-//#################### AUTO BRAMP ####################
-                    if(current.brampMethod == BRAMP_METHOD_AUTO)
-                    {
-                        if(light.underThreshold && current.nightMode != BRAMP_TARGET_AUTO)
-                        {
-                            if(current.nightMode == BRAMP_TARGET_CUSTOM)
-                            {
-                                status.rampTarget = (float)status.nightTarget;
-                            }
-                            else
-                            {
-                                //if(light.slope <= 1 && status.lightStart == status.nightTarget && lightReading - light.integrated >= 3) // respond quickly during night-to-day once we see light
-                                //{
-                                //    DEBUG(STR(" -----> ramping toward sunrise\r\n"));
-                                //    status.rampTarget = -BRAMP_RATE_MAX; //status.lightStart - (float)(NIGHT_THRESHOLD - status.nightTarget);
-                                //}
-                                //else
-                                //{
-                                    DEBUG(STR(" -----> holding night exposure\r\n"));
-                                    status.rampTarget = status.lightStart - (float)status.nightTarget; // hold at night exposure
-                                //}
-                            }
-                        }
-                        else
-                        {
-                            DEBUG(STR(" -----> using light sensor target\r\n"));
-                            status.rampTarget = (status.lightStart - lightReading);
-                        }
-
-                        if(status.rampTarget > status.rampMax) status.rampTarget = status.rampMax;
-                        if(status.rampTarget < status.rampMin) status.rampTarget = status.rampMin;
-                        float delta = status.rampTarget - status.rampStops;
-
-                        float pastError = 0.0;
-                        for(uint8_t i = 0; i < PAST_ERROR_COUNT; i++)
-                        {
-                            pastError += pastErrors[i];
-                            if(i < PAST_ERROR_COUNT - 1) pastErrors[i] = pastErrors[i + 1];
-                        }
-                        pastError /= PAST_ERROR_COUNT;
-                        pastErrors[PAST_ERROR_COUNT - 1] = delta;
-
-                        if(delta != 0)
-                        {
-                            delta *= P_FACTOR;
-                            if(!light.underThreshold) delta += pastError * I_FACTOR;
-
-                            if(light.lockedSlope > 0.0 && current.nightMode != BRAMP_TARGET_AUTO)
-                            {
-                                if(light.lockedSlope < delta) delta = light.lockedSlope; // hold the last valid slope reading from the light sensor
-                            }
-                            else
-                            {
-                                delta += light.slope * D_FACTOR;
-                            }
-
-                        }
-
-                        rampRate = (int8_t) delta;
-                    }
-//####################################################
-
-                    status.rampStops += ((float)rampRate / (3600.0 / 3)) * ((float)status.interval / 10.0);
-
-                    if(status.rampStops >= status.rampMax)
-                    {
-                        rampRate = 0;
-                        status.rampStops = status.rampMax;
-                    }
-                    else if(status.rampStops <= status.rampMin)
-                    {
-                        rampRate = 0;
-                        status.rampStops = status.rampMin;
-                    }
-                    exp = camera.bulbTime(current.BulbStart - status.rampStops - (float)evShift);
-                }
-
-                bulb_length = exp;
-
-                if(current.IntervalMode == INTERVAL_MODE_AUTO) // Auto Interval
-                {
-                    float intPercent = (status.rampStops + ((float)camera.bulbMin() - (float)current.BulbStart)) / (float) ((int8_t)camera.bulbMin() - (int8_t)BulbMaxEv);
-
-                    if(intPercent > 1.0) intPercent = 1.0;
-                    if(intPercent < 0.0) intPercent = 0.0;
-
-                    status.interval = current.GapMin + (uint16_t)(intPercent * (float)(current.Gap - current.GapMin));
-
-                    if(conf.debugEnabled)
-                    {
-                        DEBUG(PSTR("rampStops: "));
-                        DEBUG(status.rampStops);
-                        DEBUG_NL();
-                    }
-                }
-                else // Fixed Interval
-                {
-                    status.interval = current.Gap;
-                }
-
-
-                calculateExposure(&bulb_length, &aperture, &iso, &evShift);
-
-                // bulb_length, aperture, iso, evShift, seconds, interval, light.lockedSlope, lightReading
-
-                LOGGER(bulb_length); //0
-                LOGGER(',');
-                LOGGER(aperture); //1
-                LOGGER(',');
-                LOGGER(iso); //2
-                LOGGER(',');
-                LOGGER(evShift); //3
-                LOGGER(',');
-                LOGGER(lightReading); //4
-                LOGGER(',');
-                LOGGER(light.lockedSlope); //5
-                LOGGER(',');
-                LOGGER(light.slope); //6
-                LOGGER(',');
-                LOGGER(clock.Seconds()); //7
-                LOGGER(',');
-                LOGGER(status.interval); //8
-                LOGGER(',');
-                LOGGER(status.nightTarget); //9
-                LOGGER(',');
-                LOGGER(status.rampStops); //10
-                LOGGER_NL();
-
-
-                shutter_off_quick(); // Can't change parameters when half-pressed
-                if((conf.brampMode & BRAMP_MODE_APERTURE) && camera.supports.aperture)
-                {
-                    // Change the Aperture //
-                    if(camera.aperture() != aperture)
-                    {
-                        DEBUG(PSTR("Setting Aperture..."));
-                        if(camera.setAperture(aperture) == PTP_RETURN_ERROR)
-                        {
-                            DEBUG(PSTR("ERROR!!!\r\n"));
-                            run_state = RUN_ERROR;
-                            return CONTINUE;
-                        }
-                        DEBUG_NL();
-                    }
-                }
-                if((conf.brampMode & BRAMP_MODE_ISO) && camera.supports.iso)
-                {
-                    // Change the ISO //
-                    if(camera.iso() != iso)
-                    {
-                        DEBUG(PSTR("Setting ISO..."));
-                        if(camera.setISO(iso) == PTP_RETURN_ERROR)
-                        {
-                            DEBUG(PSTR("ERROR!!!\r\n"));
-                            run_state = RUN_ERROR;
-                            return CONTINUE;
-                        }
-                        DEBUG_NL();
-                    }
-                }
-                
-                if(conf.debugEnabled)
-                {
-                    DEBUG(PSTR("   Seconds: "));
-                    DEBUG((uint16_t)clock.Seconds());
-                    DEBUG_NL();
-                    DEBUG(PSTR("   evShift: "));
-                    DEBUG(evShift);
-                    DEBUG_NL();
-                    DEBUG(PSTR("BulbLength: "));
-                    DEBUG((uint16_t)bulb_length);
-                    if(found) DEBUG(PSTR(" (calculated)"));
-                    DEBUG_NL();
-                }
-            }
-
-            if(current.Mode & HDR)
-            {
-                uint8_t tv_offset = ((current.Exps - 1) / 2) * current.Bracket - exps * current.Bracket;
-                if(current.Mode & RAMP)
-                {
-                    bulb_length = camera.shiftBulb(bulb_length, tv_offset);
-                }
-                else
-                {
-                    shutter_off_quick(); // Can't change parameters when half-pressed
-                    m = camera.shutterType(current.Exp - tv_offset);
-                    if(m == 0) m = SHUTTER_MODE_PTP;
-
-                    if(m & SHUTTER_MODE_PTP)
-                    {
-                        DEBUG(PSTR("Shutter Mode PTP\r\n"));
-                        camera.setShutter(current.Exp - tv_offset);
-                        bulb_length = camera.bulbTime((int8_t)(current.Exp - tv_offset));
-                    }
-                    else
-                    {
-                        camera.bulbMode();
-                        DEBUG(PSTR("Shutter Mode BULB\r\n"));
-                        m = SHUTTER_MODE_BULB;
-                        bulb_length = camera.bulbTime((int8_t)(current.Exp - tv_offset));
-                    }
-                }
-
-                if(conf.debugEnabled)
-                {
-                    DEBUG_NL();
-                    DEBUG(PSTR("Mode: "));
-                    DEBUG(m);
-                    DEBUG_NL();
-                    DEBUG(PSTR("Tv: "));
-                    DEBUG(current.Exp - tv_offset);
-                    DEBUG_NL();
-                    DEBUG(PSTR("Bulb: "));
-                    DEBUG((uint16_t)bulb_length);
-                    DEBUG_NL();
-                }
-            }
-            
-            if((current.Mode & (HDR | RAMP)) == 0)
-            {
-                if(conf.debugEnabled)
-                {
-                    DEBUG(PSTR("***Using exp: "));
-                    DEBUG(exp);
-                    DEBUG(PSTR(" ("));
-                    DEBUG(current.Exp);
-                    DEBUG(PSTR(")"));
-                    DEBUG_NL();
-                }
-                bulb_length = exp;
-                if(m & SHUTTER_MODE_PTP)
-                {
-                    shutter_off_quick(); // Can't change parameters when half-pressed
-                    camera.manualMode();
-                    camera.setShutter(current.Exp);
-                }
-            }
-
-            status.bulbLength = bulb_length;
+            frame_open_ms = clock.Ms();
+            frameTimed = 0;
 
             if(current.Mode & RAMP && (!camera.isInBulbMode() && camera.ready))
             {
-                DEBUG(PSTR("\r\n-->Using Extended Ramp\r\n"));
-                DEBUG(PSTR("    ms: "));
-                DEBUG(bulb_length);
-                DEBUG_NL();
-                DEBUG(PSTR("    ev: "));
-                DEBUG(camera.bulbToShutterEv(bulb_length));
-                DEBUG_NL();
-                DEBUG_NL();
-                camera.setShutter(camera.bulbToShutterEv(bulb_length));
                 shutter_capture();
+                camera.expectEvent(nextBulbLength);
                 _delay_ms(10);
                 if(lastShutterError)
                 {
@@ -1152,12 +906,13 @@ char shutter::task()
                     return CONTINUE; // try it again
                 }
             }
-            else if(m & SHUTTER_MODE_BULB)
+            else if(nextShutterMode & SHUTTER_MODE_BULB)
             {
                 //DEBUG(PSTR("Running BULB\r\n"));
                 camera.bulb_open = true;
+                frameTimed = 1;
                 		
-                clock.bulb(bulb_length);
+                clock.bulb(nextBulbLength);
                 _delay_ms(10);
 				
 				
@@ -1174,10 +929,34 @@ char shutter::task()
             {
                 //DEBUG(PSTR("Running Capture\r\n"));
                 shutter_capture();
+                camera.expectEvent(nextBulbLength);
+            }
+
+            if(conf.debugEnabled)
+            {
+                DEBUG(PSTR("State: RUN_BULB"));
+                DEBUG_NL();
+                if(exps == 0 && frame_scheduled_ms)
+                {
+                    DEBUG(PSTR("Start jitter (ms): "));
+                    DEBUG((int16_t)(frame_open_ms - frame_scheduled_ms));
+                    DEBUG_NL();
+                }
             }
         }
         else if(!clock.bulbRunning && !camera.busy)
         {
+            if(frameTimed)
+            {
+                // Timed by the clock -- use the real open/close (PC sync) times
+                timingStatAdd(&timing.bulb, (int32_t)(clock.bulbCloseMs - clock.bulbOpenMs) - (int32_t)nextBulbLength);
+                frameTiming(exps == 0, clock.bulbOpenMs, clock.bulbCloseMs);
+            }
+            else
+            {
+                frameTiming(exps == 0, frame_open_ms, clock.Ms());
+            }
+            nextReady = 0;
             exps++;
 
             lightReading = light.readIntegratedEv();
@@ -1257,7 +1036,11 @@ char shutter::task()
         }
 
         status.photosRemaining = current.Photos - photos;
-        status.photosTaken = photos;
+        if(status.photosTaken != photos)
+        {
+            status.photosTaken = photos;
+            notify.changed(WATCH_STATUS);
+        }
     }
     
     if(run_state == RUN_GAP)
@@ -1271,6 +1054,7 @@ char shutter::task()
                 DEBUG_NL();
             }
             strcpy((char *) status.textStatus, TEXT("Waiting"));
+            notify.changed(WATCH_STATUS);
             old_state = run_state;
         }
 
@@ -1282,15 +1066,37 @@ char shutter::task()
         {
             uint32_t cms = clock.Ms();
 
+            if(!nextReady && (current.Exp > 0 || (current.Mode & RAMP) || conf.arbitraryBulb))
+            {
+                // The previous frame is done -- get the next one ready while there's time
+                if(prepareExposure(0, (last_photo_ms + (uint32_t)status.interval * 100) / 1000))
+                {
+                    run_state = RUN_ERROR;
+                    return CONTINUE;
+                }
+                cms = clock.Ms();
+            }
+
             if((cms - last_photo_ms) / 100 >= status.interval)
             {
+                frame_scheduled_ms = last_photo_ms + (uint32_t)status.interval * 100;
                 last_photo_ms = cms;
                 clock.tare();
                 run_state = RUN_PHOTO;
             } 
             else
             {
-                status.nextPhoto = (unsigned int) ((status.interval - (cms - last_photo_ms) / 100) / 10);
+                uint32_t next_ms = last_photo_ms + (uint32_t)status.interval * 100;
+                if(next_ms - cms > (uint32_t)settings_mirror_up_time * 1000)
+                    clock.wakeAt(next_ms - (uint32_t)settings_mirror_up_time * 1000);
+                clock.wakeAt(next_ms);
+
+                unsigned int next = (unsigned int) ((status.interval - (cms - last_photo_ms) / 100) / 10);
+                if(status.nextPhoto != next)
+                {
+                    status.nextPhoto = next;
+                    notify.changed(WATCH_STATUS);
+                }
                 if((cms - last_photo_ms) / 100 + (uint32_t)settings_mirror_up_time * 10 >= status.interval)
                 {
                     // Mirror Up //
@@ -1316,6 +1122,7 @@ char shutter::task()
             }
             menu.blink();
             strcpy((char *) status.textStatus, TEXT("Error"));
+            notify.changed(WATCH_STATUS);
             old_state = run_state;
 
             //if(PTP_Connected && PTP_Error)
@@ -1355,6 +1162,7 @@ char shutter::task()
                 DEBUG_NL();
             }
             strcpy((char *) status.textStatus, TEXT("Done"));
+            notify.changed(WATCH_STATUS);
             old_state = run_state;
         }
 
@@ -1362,6 +1170,7 @@ char shutter::task()
         paused = 0;
         enter = 0;
         running = 0;
+        notify.changed(WATCH_RUNNING);
         shutter_off();
         camera.bulbEnd();
         hardware_flashlight(0);
@@ -1375,9 +1184,407 @@ char shutter::task()
         return DONE;
     }
 
+    if(run_state != RUN_DELAY && run_state != RUN_GAP) clock.wakeAt(clock.Ms()); // mid-frame, don't idle
+
     return CONTINUE;
 }
 
+/******************************************************************
+ *
+ *   shutter::prepareExposure
+ *   Works out the exposure for the next frame and applies any
+ *   camera settings it needs, so that RUN_BULB only has to fire.
+ *   seconds is the time the frame is scheduled to start.
+ *   Returns 1 if the camera settings couldn't be changed.
+ *
+ ******************************************************************/
+
+uint8_t shutter::prepareExposure(uint8_t exps, uint32_t seconds)
+{
+    static uint32_t exp;
+
+    nextShutterMode = camera.shutterType(current.Exp);
+    if(nextShutterMode & SHUTTER_MODE_BULB || conf.arbitraryBulb)
+    {
+        if(conf.arbitraryBulb)
+        {
+            exp = current.ArbExp * 100;
+            nextShutterMode = SHUTTER_MODE_BULB;
+        }
+        else
+        {
+            exp = camera.bulbTime((int8_t)current.Exp);
+        }
+    }
+
+    if(current.Mode & RAMP)
+    {
+        float key1 = 1, key2 = 1, key3 = 1, key4 = 1;
+        char found = 0;
+        uint8_t i;
+        nextShutterMode = SHUTTER_MODE_BULB;
+        shutter_off();
+
+
+        if(current.brampMethod == BRAMP_METHOD_KEYFRAME) //////////////////////////////// KEYFRAME RAMP /////////////////////////////////////
+        {
+            // Bulb ramp algorithm goes here
+            for(i = 0; i < current.Keyframes; i++)
+            {
+                if(seconds <= current.Key[i])
+                {
+                    found = 1;
+                    if(i == 0)
+                    {
+                        key2 = key1 = (float)(current.BulbStart);
+                    }
+                    else if(i == 1)
+                    {
+                        key1 = (float)(current.BulbStart);
+                        key2 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i - 1]));
+                    }
+                    else
+                    {
+                        key1 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i - 2]));
+                        key2 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i - 1]));
+                    }
+                    key3 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i]));
+                    key4 = (float)((int8_t)current.BulbStart - *((int8_t*)&current.Bulb[i < (current.Keyframes - 1) ? i + 1 : i]));
+                    break;
+                }
+            }
+            
+            if(found)
+            {
+                uint32_t var1 = seconds;
+                uint32_t var2 = (i > 0 ? current.Key[i - 1] : 0);
+                uint32_t var3 = current.Key[i];
+
+                float t = (float)(var1 - var2) / (float)(var3 - var2);
+                float curveEv = curve(key1, key2, key3, key4, t);
+                status.rampStops = (float)current.BulbStart - curveEv;
+                exp = camera.bulbTime(curveEv - (float)evShift);
+
+                if(conf.debugEnabled)
+                {
+                    DEBUG(PSTR("   Keyframe: "));
+                    DEBUG(i);
+                    DEBUG_NL();
+                    DEBUG(PSTR("    Percent: "));
+                    DEBUG(t);
+                    DEBUG_NL();
+                    DEBUG(PSTR("    CurveEv: "));
+                    DEBUG(curveEv);
+                    DEBUG_NL();
+                    DEBUG(PSTR("CorrectedEv: "));
+                    DEBUG(curveEv - (float)evShift);
+                    DEBUG_NL();
+                    DEBUG(PSTR("   Exp (ms): "));
+                    DEBUG(exp);
+                    DEBUG_NL();
+                    DEBUG(PSTR("    evShift: "));
+                    DEBUG(evShift);
+                    DEBUG_NL();
+                }
+            }
+            else
+            {
+                status.rampStops = (float)((int8_t)(current.BulbStart - (current.BulbStart - *((int8_t*)&current.Bulb[current.Keyframes - 1]))));
+                exp = camera.bulbTime((int8_t)(current.BulbStart - *((int8_t*)&current.Bulb[current.Keyframes - 1]) - (float)evShift));
+            }
+        }
+
+        else if(current.brampMethod == BRAMP_METHOD_GUIDED || current.brampMethod == BRAMP_METHOD_AUTO) //////////////////////////////// GUIDED / AUTO RAMP /////////////////////////////////////
+        {
+
+//#################### AUTO BRAMP ####################
+            if(current.brampMethod == BRAMP_METHOD_AUTO)
+            {
+                if(light.underThreshold && current.nightMode != BRAMP_TARGET_AUTO)
+                {
+                    if(current.nightMode == BRAMP_TARGET_CUSTOM)
+                    {
+                        status.rampTarget = (float)status.nightTarget;
+                    }
+                    else
+                    {
+                        //if(light.slope <= 1 && status.lightStart == status.nightTarget && lightReading - light.integrated >= 3) // respond quickly during night-to-day once we see light
+                        //{
+                        //    DEBUG(STR(" -----> ramping toward sunrise\r\n"));
+                        //    status.rampTarget = -BRAMP_RATE_MAX; //status.lightStart - (float)(NIGHT_THRESHOLD - status.nightTarget);
+                        //}
+                        //else
+                        //{
+                            DEBUG(STR(" -----> holding night exposure\r\n"));
+                            status.rampTarget = status.lightStart - (float)status.nightTarget; // hold at night exposure
+                        //}
+                    }
+                }
+                else
+                {
+                    DEBUG(STR(" -----> using light sensor target\r\n"));
+                    status.rampTarget = (status.lightStart - lightReading);
+                }
+
+                if(status.rampTarget > status.rampMax) status.rampTarget = status.rampMax;
+                if(status.rampTarget < status.rampMin) status.rampTarget = status.rampMin;
+                float delta = status.rampTarget - status.rampStops;
+
+                float pastError = 0.0;
+                for(uint8_t i = 0; i < PAST_ERROR_COUNT; i++)
+                {
+                    pastError += pastErrors[i];
+                    if(i < PAST_ERROR_COUNT - 1) pastErrors[i] = pastErrors[i + 1];
+                }
+                pastError /= PAST_ERROR_COUNT;
+                pastErrors[PAST_ERROR_COUNT - 1] = delta;
+
+                if(delta != 0)
+                {
+                    delta *= P_FACTOR;
+                    if(!light.underThreshold) delta += pastError * I_FACTOR;
+
+                    if(light.lockedSlope > 0.0 && current.nightMode != BRAMP_TARGET_AUTO)
+                    {
+                        if(light.lockedSlope < delta) delta = light.lockedSlope; // hold the last valid slope reading from the light sensor
+                    }
+                    else
+                    {
+                        delta += light.slope * D_FACTOR;
+                    }
+
+                }
+
+                rampRate = (int8_t) delta;
+            }
+//####################################################
+
+            status.rampStops += ((float)rampRate / (3600.0 / 3)) * ((float)status.interval / 10.0);
+
+            if(status.rampStops >= status.rampMax)
+            {
+                rampRate = 0;
+                status.rampStops = status.rampMax;
+            }
+            else if(status.rampStops <= status.rampMin)
+            {
+                rampRate = 0;
+                status.rampStops = status.rampMin;
+            }
+            exp = camera.bulbTime(current.BulbStart - status.rampStops - (float)evShift);
+        }
+
+        nextBulbLength = exp;
+
+        if(current.IntervalMode == INTERVAL_MODE_AUTO) // Auto Interval
+        {
+            float intPercent = (status.rampStops + ((float)camera.bulbMin() - (float)current.BulbStart)) / (float) ((int8_t)camera.bulbMin() - (int8_t)BulbMaxEv);
+
+            if(intPercent > 1.0) intPercent = 1.0;
+            if(intPercent < 0.0) intPercent = 0.0;
+
+            status.interval = current.GapMin + (uint16_t)(intPercent * (float)(current.Gap - current.GapMin));
+
+            if(conf.debugEnabled)
+            {
+                DEBUG(PSTR("rampStops: "));
+                DEBUG(status.rampStops);
+                DEBUG_NL();
+            }
+        }
+        else // Fixed Interval
+        {
+            status.interval = current.Gap;
+        }
+
+
+        calculateExposure(&nextBulbLength, &aperture, &iso, &evShift);
+
+        // nextBulbLength, aperture, iso, evShift, seconds, interval, light.lockedSlope, lightReading
+
+        LOGGER(nextBulbLength); //0
+        LOGGER(',');
+        LOGGER(aperture); //1
+        LOGGER(',');
+        LOGGER(iso); //2
+        LOGGER(',');
+        LOGGER(evShift); //3
+        LOGGER(',');
+        LOGGER(lightReading); //4
+        LOGGER(',');
+        LOGGER(light.lockedSlope); //5
+        LOGGER(',');
+        LOGGER(light.slope); //6
+        LOGGER(',');
+        LOGGER(seconds); //7
+        LOGGER(',');
+        LOGGER(status.interval); //8
+        LOGGER(',');
+        LOGGER(status.nightTarget); //9
+        LOGGER(',');
+        LOGGER(status.rampStops); //10
+        LOGGER_NL();
+
+
+        shutter_off_quick(); // Can't change parameters when half-pressed
+        if((conf.brampMode & BRAMP_MODE_APERTURE) && camera.supports.aperture)
+        {
+            // Change the Aperture //
+            if(camera.aperture() != aperture)
+            {
+                DEBUG(PSTR("Setting Aperture..."));
+                if(camera.setAperture(aperture) == PTP_RETURN_ERROR)
+                {
+                    DEBUG(PSTR("ERROR!!!\r\n"));
+                    return 1;
+                }
+                DEBUG_NL();
+            }
+        }
+        if((conf.brampMode & BRAMP_MODE_ISO) && camera.supports.iso)
+        {
+            // Change the ISO //
+            if(camera.iso() != iso)
+            {
+                DEBUG(PSTR("Setting ISO..."));
+                if(camera.setISO(iso) == PTP_RETURN_ERROR)
+                {
+                    DEBUG(PSTR("ERROR!!!\r\n"));
+                    return 1;
+                }
+                DEBUG_NL();
+            }
+        }
+        
+        if(conf.debugEnabled)
+        {
+            DEBUG(PSTR("   Seconds: "));
+            DEBUG((uint16_t)seconds);
+            DEBUG_NL();
+            DEBUG(PSTR("   evShift: "));
+            DEBUG(evShift);
+            DEBUG_NL();
+            DEBUG(PSTR("BulbLength: "));
+            DEBUG((uint16_t)nextBulbLength);
+            if(found) DEBUG(PSTR(" (calculated)"));
+            DEBUG_NL();
+        }
+    }
+
+    if(current.Mode & HDR)
+    {
+        uint8_t tv_offset = ((current.Exps - 1) / 2) * current.Bracket - exps * current.Bracket;
+        if(current.Mode & RAMP)
+        {
+            nextBulbLength = camera.shiftBulb(nextBulbLength, tv_offset);
+        }
+        else
+        {
+            shutter_off_quick(); // Can't change parameters when half-pressed
+            nextShutterMode = camera.shutterType(current.Exp - tv_offset);
+            if(nextShutterMode == 0) nextShutterMode = SHUTTER_MODE_PTP;
+
+            if(nextShutterMode & SHUTTER_MODE_PTP)
+            {
+                DEBUG(PSTR("Shutter Mode PTP\r\n"));
+                camera.setShutter(current.Exp - tv_offset);
+                nextBulbLength = camera.bulbTime((int8_t)(current.Exp - tv_offset));
+            }
+            else
+            {
+                camera.bulbMode();
+                DEBUG(PSTR("Shutter Mode BULB\r\n"));
+                nextShutterMode = SHUTTER_MODE_BULB;
+                nextBulbLength = camera.bulbTime((int8_t)(current.Exp - tv_offset));
+            }
+        }
+
+        if(conf.debugEnabled)
+        {
+            DEBUG_NL();
+            DEBUG(PSTR("Mode: "));
+            DEBUG(nextShutterMode);
+            DEBUG_NL();
+            DEBUG(PSTR("Tv: "));
+            DEBUG(current.Exp - tv_offset);
+            DEBUG_NL();
+            DEBUG(PSTR("Bulb: "));
+            DEBUG((uint16_t)nextBulbLength);
+            DEBUG_NL();
+        }
+    }
+    
+    if((current.Mode & (HDR | RAMP)) == 0)
+    {
+        if(conf.debugEnabled)
+        {
+            DEBUG(PSTR("***Using exp: "));
+            DEBUG(exp);
+            DEBUG(PSTR(" ("));
+            DEBUG(current.Exp);
+            DEBUG(PSTR(")"));
+            DEBUG_NL();
+        }
+        nextBulbLength = exp;
+        if(nextShutterMode & SHUTTER_MODE_PTP)
+        {
+            shutter_off_quick(); // Can't change parameters when half-pressed
+            camera.manualMode();
+            camera.setShutter(current.Exp);
+        }
+    }
+
+    status.bulbLength = nextBulbLength;
+    notify.changed(WATCH_STATUS); // ramp stops, interval and exposure move every frame
+
+    if(current.Mode & RAMP && (!camera.isInBulbMode() && camera.ready))
+    {
+        DEBUG(PSTR("\r\n-->Using Extended Ramp\r\n"));
+        DEBUG(PSTR("    ms: "));
+        DEBUG(nextBulbLength);
+        DEBUG_NL();
+        DEBUG(PSTR("    ev: "));
+        DEBUG(camera.bulbToShutterEv(nextBulbLength));
+        DEBUG_NL();
+        DEBUG_NL();
+        camera.setShutter(camera.bulbToShutterEv(nextBulbLength));
+    }
+
+    nextReady = 1;
+    return 0;
+}
+
+/******************************************************************
+ *
+ *   shutter::frameTiming
+ *
+ *   Records how late the exposure opened and the dead time since
+ *   the last one closed (first exposure of a frame only)
+ *
+ ******************************************************************/
+
+void shutter::frameTiming(uint8_t first, uint32_t open_ms, uint32_t close_ms)
+{
+    if(first)
+    {
+        if(frame_scheduled_ms) timingStatAdd(&timing.start, (int32_t)(open_ms - frame_scheduled_ms));
+        if(frame_close_ms) timingStatAdd(&timing.dead, (int32_t)(open_ms - frame_close_ms));
+    }
+    frame_close_ms = close_ms;
+}
+
+/******************************************************************
+ *
+ *   shutter::resetTiming
+ *
+ *
+ ******************************************************************/
+
+void shutter::resetTiming(void)
+{
+    memset(&timing, 0, sizeof(timing));
+}
+
 void shutter::calculateExposure(uint32_t *nextBulbLength, uint8_t *nextAperture, uint8_t *nextISO, int8_t *bulbChangeEv)
 {
     if(camera.supports.iso || camera.supports.aperture || camera.supports.shutter)
@@ -1528,6 +1735,7 @@ void shutter::switchToGuided()
 {
     rampRate = 0;
     current.brampMethod = BRAMP_METHOD_GUIDED;
+    notify.changed(WATCH_PROGRAM);
 }
 
 void shutter::switchToAuto()
@@ -1536,6 +1744,8 @@ void shutter::switchToAuto()
     lightReading = status.lightStart = light.readIntegratedEv();
     current.brampMethod = BRAMP_METHOD_AUTO;
     current.nightMode = BRAMP_TARGET_AUTO;
+    notify.changed(WATCH_STATUS);
+    notify.changed(WATCH_PROGRAM);
 }
 
 void check_cable()
@@ -1549,8 +1759,8 @@ void aux_pulse()
     aux2_on();
     if(conf.dollyPulse == 65535) conf.dollyPulse = 100;
     if(conf.dollyPulse2 == 65535) conf.dollyPulse2 = 100;
-    clock.in(conf.dollyPulse, &aux1_off);
-    clock.in(conf.dollyPulse2, &aux2_off);
+    clock.in(conf.dollyPulse, &aux1_off, CLOCK_TIMER_ISR);
+    clock.in(conf.dollyPulse2, &aux2_off, CLOCK_TIMER_ISR);
 }
 
 void aux1_on()
@@ -1575,6 +1785,51 @@ void aux2_off()
     ENABLE_AUX_PORT2;
 }
 
+void timingStatAdd(timing_stat *s, int32_t value)
+{
+    uint32_t mag = value < 0 ? 0 - value : value;
+    uint8_t b = 0;
+
+    while(mag && b < TIMING_STAT_BUCKETS - 1)
+    {
+        mag >>= 1;
+        b++;
+    }
+
+    if(s->count == 0 || value < s->min) s->min = value;
+    if(s->count == 0 || value > s->max) s->max = value;
+    if(s->count < 65535) s->count++;
+    s->mean += ((float)value - s->mean) / (float)s->count;
+
+    if(s->histogram[b] == 65535) // keep the shape, drop the resolution
+    {
+        for(uint8_t i = 0; i < TIMING_STAT_BUCKETS; i++) s->histogram[i] >>= 1;
+    }
+    s->histogram[b]++;
+}
+
+// Upper bound of the bucket holding the 99th percentile of |value|, capped at the worst seen
+uint32_t timingStatP99(timing_stat *s)
+{
+    uint32_t total = 0, above = 0, worst;
+    uint8_t b;
+
+    worst = (uint32_t)(s->max > 0 - s->min ? s->max : 0 - s->min);
+
+    for(b = 0; b < TIMING_STAT_BUCKETS; b++) total += s->histogram[b];
+
+    for(b = TIMING_STAT_BUCKETS; b-- > 0;)
+    {
+        above += s->histogram[b];
+        if(above * 100 > total)
+        {
+            if(b == TIMING_STAT_BUCKETS - 1 || ((1UL << b) - 1) > worst) return worst;
+            return (1UL << b) - 1;
+        }
+    }
+    return 0;
+}
+
 uint8_t stopName(char name[8], uint8_t stop)
 {
     name[0] = ' ';
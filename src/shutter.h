@@ -135,8 +135,28 @@ struct timer_status
     float lightStart;
 };
 
+#define TIMING_STAT_BUCKETS 16
+
+struct timing_stat
+{
+    int32_t min;
+    int32_t max;
+    float mean;
+    uint16_t count;
+    uint16_t histogram[TIMING_STAT_BUCKETS]; // by log2(|ms|), bucket n holds 2^(n-1) to 2^n-1
+};
+
+struct timing_stats
+{
+    timing_stat start; // shutter opened - scheduled (ms)
+    timing_stat bulb;  // measured - requested bulb (ms)
+    timing_stat dead;  // previous frame closed to this frame opened (ms)
+};
+
 extern program stored[MAX_STORED+1]EEMEM;
 
+#define PROGRAM_HASH_EMPTY 0 // storedHash of a slot with nothing saved
+
 struct keyframe_t {
     int16_t value;
     uint32_t seconds;
@@ -169,7 +189,10 @@ public:
     void load(char id);
     void setDefault(void);
     int8_t nextId(void);
+    uint16_t storedHash(char id);
+    uint8_t store(char id, program *p);
     void calculateExposure(uint32_t *nextBulbLength, uint8_t *nextAperture, uint8_t *nextISO, int8_t *bulbChangeEv);
+    void resetTiming(void);
 
     void saveCurrent(void);
     void restoreCurrent(void);
@@ -198,14 +221,22 @@ public:
     float pastErrors[PAST_ERROR_COUNT];
     volatile uint8_t paused, pausing, apertureReady;
     int8_t evShift;
+    timing_stats timing;
 
 private:
+    uint8_t prepareExposure(uint8_t exps, uint32_t seconds);
+    void frameTiming(uint8_t first, uint32_t open_ms, uint32_t close_ms);
+
     double test;
     uint8_t iso;
     uint8_t aperture;
+    uint32_t nextBulbLength;
+    uint8_t nextShutterMode, nextReady, frameTimed;
+    uint32_t frame_scheduled_ms, frame_open_ms, frame_close_ms;
 };
 
 void check_cable();
+uint16_t program_hash(program *p);
 void shutter_off(void);
 void shutter_off_quick(void);
 void shutter_half(void);
@@ -219,6 +250,8 @@ void aux1_off(void);
 void aux2_on(void);
 void aux2_off(void);
 void aux_pulse(void);
+void timingStatAdd(timing_stat *s, int32_t value);
+uint32_t timingStatP99(timing_stat *s);
 uint8_t stopName(char name[7], uint8_t stop);
 uint8_t stopUp(uint8_t stop);
 uint8_t stopDown(uint8_t stop);
@@ -37,6 +37,10 @@
 #include "remote.h"
 #include "tlp_menu_functions.h"
 #include "notify.h"
+#include "events.h"
+#include "scheduler.h"
+#include "adc.h"
+#include "energy.h"
 #include "PTP.h"
 #include "light.h"
 #include "nmx.h"
@@ -48,42 +52,7 @@
 
 char system_tested EEMEM;
 
-extern volatile uint8_t showGap;
-extern volatile uint8_t timerNotRunning;
-extern volatile uint8_t modeHDR;
-extern volatile uint8_t modeTimelapse;
-extern volatile uint8_t modeStandard;
-extern volatile uint8_t modeStandardExp;
-extern volatile uint8_t modeStandardExpNikon;
-extern volatile uint8_t modeStandardExpArb;
-extern volatile uint8_t modeRamp;
-extern volatile uint8_t modeNoRamp;
-extern volatile uint8_t modeRampKeyAdd;
-extern volatile uint8_t modeRampKeyDel;
-extern volatile uint8_t modeBulb;
-extern volatile uint8_t bulb1;
-extern volatile uint8_t bulb2;
-extern volatile uint8_t bulb3;
-extern volatile uint8_t bulb4;
-extern volatile uint8_t bulb5;
-extern volatile uint8_t bulb6;
-extern volatile uint8_t bulb7;
-extern volatile uint8_t bulb8;
-extern volatile uint8_t bulb9;
-extern volatile uint8_t showRemoteStart;
-extern volatile uint8_t showRemoteInfo;
-extern volatile uint8_t brampKeyframe;
-extern volatile uint8_t brampGuided;
-extern volatile uint8_t brampAuto;
-extern volatile uint8_t brampNotAuto;
-extern volatile uint8_t brampNotGuided;
-extern volatile uint8_t showIntervalMaxMin;
-extern volatile uint8_t modeRampNormal;
-extern volatile uint8_t modeRampExtended;
-extern volatile uint8_t rampISO;
-extern volatile uint8_t rampAperture;
-extern volatile uint8_t rampTargetCustom;
-extern volatile uint8_t cameraMakeNikon;
+extern uint32_t conditionPasses, conditionUpdates;
 
 volatile uint8_t connectUSBcamera = 0;
 
@@ -102,6 +71,9 @@ BT bt = BT();
 IR ir = IR();
 Remote remote = Remote();
 Notify notify = Notify();
+EventQueue events = EventQueue();
+Scheduler scheduler = Scheduler();
+Energy energy = Energy();
 PTP camera = PTP();
 Light light = Light();
 
@@ -182,10 +154,11 @@ void setup()
 	menu.lcd = &lcd;
 	menu.button = &button;
 
-	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	set_sleep_mode(SLEEP_MODE_IDLE); // for Clock::idle -- timers, USART and USB keep running
 	sleep_enable();
 
 	battery_percent = battery_read();
+	battery_init();
 
 	VirtualSerial_Init();
 
@@ -215,6 +188,28 @@ void setup()
 #endif
 }
 
+/******************************************************************
+ *
+ *   schedule
+ *   Adds a main loop task.  A task that doesn't fit would silently
+ *   never run, so this stops with its name on the screen instead.
+ *
+ ******************************************************************/
+
+void schedule(void (*func)(), const char *name, uint8_t priority, uint16_t period, uint16_t deadline)
+{
+	if(scheduler.add(func, name, priority, period, deadline)) return;
+
+	char buf[16];
+	strcpy_P(buf, name);
+	lcd.cls();
+	lcd.writeString(1, 8, STR("SCHED_TASKS"));
+	lcd.writeString(1, 17, STR("too small for"));
+	lcd.writeString(1, 26, buf);
+	lcd.update();
+	for(;;);
+}
+
 /******************************************************************
  *
  *   main
@@ -249,11 +244,9 @@ int main()
 
 	lcd.update();
 
-	uint16_t count = 0;
-
-	notify.watch(NOTIFY_CHARGE, (void *)&charge_status, sizeof(charge_status), &message_notify);
-	notify.watch(NOTIFY_BT, (void *)&remote.connected, sizeof(remote.connected), &message_notify);
-	notify.watch(NOTIFY_CAMERA, (void *)&PTP_Ready, sizeof(PTP_Ready), &message_notify);
+	notify.watch(NOTIFY_CHARGE, WATCH_CHARGE, &message_notify);
+	notify.watch(NOTIFY_BT, WATCH_BT, &message_notify);
+	notify.watch(NOTIFY_CAMERA, WATCH_CAMERA, &message_notify);
 
 	if(conf.autoRun)
 	{
@@ -262,6 +255,22 @@ int main()
 		menu.spawn((void*)timerStatus);	
 	}
 
+	schedule(&shutterTask, PSTR("shutter"), SCHED_CRITICAL, 0, 5);
+	schedule(&clockTask, PSTR("clock"), SCHED_CRITICAL, 0, 5);
+	schedule(&buttonTask, PSTR("button"), SCHED_NORMAL, 0, 50);
+	schedule(&usbTask, PSTR("usb"), SCHED_NORMAL, 0, 0);
+	schedule(&btTask, PSTR("bt"), SCHED_NORMAL, 0, 0);
+	schedule(&cameraTask, PSTR("camera"), SCHED_NORMAL, 0, 0);
+	schedule(&lightTask, PSTR("light"), SCHED_NORMAL, 0, 0);
+	schedule(&adc_task, PSTR("adc"), SCHED_NORMAL, 0, 0);
+	schedule(&uiTask, PSTR("ui"), SCHED_BEST_EFFORT, 0, 100);
+	schedule(&lcdTask, PSTR("lcd"), SCHED_NORMAL, 0, 0);
+	schedule(&notifyTask, PSTR("notify"), SCHED_BEST_EFFORT, 0, 0);
+	schedule(&remoteTask, PSTR("remote"), SCHED_BEST_EFFORT, REMOTE_NOTIFY_MS, 0);
+	schedule(&chargeTask, PSTR("charge"), SCHED_BEST_EFFORT, 250, 0);
+	schedule(&batteryTask, PSTR("battery"), SCHED_BEST_EFFORT, 60000, 0);
+	schedule(&energyTask, PSTR("energy"), SCHED_BEST_EFFORT, ENERGY_SAMPLE_MS, 0);
+
 	/****************************
 	   Main Loop
 	*****************************/
@@ -332,6 +341,161 @@ int main()
 				    DEBUG_NL();
 				    break;
 
+			   case 'P': // camera event polling stats
+			   	    DEBUG(PSTR("Poll rate (/s): "));
+				    DEBUG(camera.pollRate);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Poll interval (ms): "));
+				    DEBUG(camera.pollInterval);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Notice latency (ms): "));
+				    DEBUG(camera.noticeLatency);
+				    DEBUG(PSTR(" max: "));
+				    DEBUG(camera.noticeLatencyMax);
+				    DEBUG_NL();
+				    break;
+
+#ifdef PTP_STATS_ENABLED
+			   case 'o': // PTP transaction stats (binary, PTP_OpStats_t[PTP_STATS_SLOTS])
+				   for(uint16_t i = 0; i < sizeof(PTP_Stats); i++)
+				   {
+					   VirtualSerial_PutChar(((char *) PTP_Stats)[i]);
+				   }
+				   break;
+#endif
+
+			   case 'O':
+				   PTP_StatsReset();
+				   break;
+
+			   case 'Z': // idle sleep stats
+			   	    DEBUG(PSTR("Run time (s): "));
+				    DEBUG(clock.runMs / 1000);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Idle time (s): "));
+				    DEBUG(clock.idleMs / 1000);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Ticks: "));
+				    DEBUG(clock.wakeups);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Tick ISR (us): "));
+				    DEBUG(clock.tickUs);
+				    DEBUG(PSTR(" max: "));
+				    DEBUG(clock.tickUsMax);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Events max: "));
+				    DEBUG(events.depthMax);
+				    DEBUG(PSTR(" dropped: "));
+				    DEBUG(events.dropped);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Timers max: "));
+				    DEBUG(clock.timersMax);
+				    DEBUG(PSTR(" refused: "));
+				    DEBUG(clock.timerOverflows);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Power-downs: "));
+				    DEBUG(clock.deepSleeps);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Tickless: "));
+				    DEBUG(clock.tickless);
+				    DEBUG(PSTR(" Battery: "));
+				    DEBUG(battery_percent);
+				    DEBUG_NL();
+				    break;
+
+			   case 'z': // toggle tickless idle (for A/B battery runs)
+				   clock.tickless = !clock.tickless;
+				   break;
+
+			   case 'D': // LCD flush stats
+			   	    DEBUG(PSTR("Frames: "));
+				    DEBUG(lcd.frames);
+				    DEBUG(PSTR(" bytes: "));
+				    DEBUG(lcd.bytesSent);
+				    DEBUG(PSTR(" avg/frame: "));
+				    DEBUG(lcd.frames ? lcd.bytesSent / lcd.frames : (uint32_t)0);
+				    DEBUG_NL();
+			   	    DEBUG(PSTR("Frame us: "));
+				    DEBUG(lcd.frameUs);
+				    DEBUG(PSTR(" max: "));
+				    DEBUG(lcd.frameUsMax);
+				    DEBUG(PSTR(" full frames: "));
+				    DEBUG(lcd.fullFrames);
+				    DEBUG_NL();
+#ifdef LCD_MIRROR_ENABLED
+			   	    DEBUG(PSTR("Mirror frames: "));
+				    DEBUG(lcd.mirrorFrames);
+				    DEBUG(PSTR(" bytes: "));
+				    DEBUG(lcd.mirrorBytes);
+				    DEBUG_NL();
+				    lcd.mirrorFrames = 0;
+				    lcd.mirrorBytes = 0;
+#endif
+				    lcd.frames = 0;
+				    lcd.bytesSent = 0;
+				    lcd.frameUsMax = 0;
+				    break;
+
+			   case 'd': // toggle full-frame LCD updates (for A/B comparison)
+				   lcd.fullFrames = !lcd.fullFrames;
+				   break;
+
+#ifdef LCD_MIRROR_ENABLED
+			   case 'W': // start the screen mirror (or resync it) with a key frame
+				   lcd.mirrorStart(&lcdMirrorPut);
+				   break;
+
+			   case 'w': // stop the screen mirror
+				   lcd.mirror = 0;
+				   break;
+#endif
+
+			   case 'k': // main loop task stats
+			   	    DEBUG(PSTR("Passes: "));
+				    DEBUG(scheduler.passes);
+				    DEBUG_NL();
+				    for(uint8_t i = 0; i < scheduler.count; i++)
+				    {
+					    sched_task_t *t = &scheduler.tasks[i];
+					    DEBUG(t->name);
+					    DEBUG(PSTR(" runs: "));
+					    DEBUG(t->runs);
+					    DEBUG(PSTR(" avg us: "));
+					    DEBUG(t->runs ? t->timeTotal / t->runs : (uint32_t)0);
+					    DEBUG(PSTR(" max us: "));
+					    DEBUG(t->timeMax);
+					    DEBUG(PSTR(" late ms: "));
+					    DEBUG(t->lateMax);
+					    DEBUG(PSTR(" overruns: "));
+					    DEBUG(t->overruns);
+					    DEBUG_NL();
+				    }
+			   	    DEBUG(PSTR("Conditions recomputed: "));
+				    DEBUG(conditionUpdates);
+				    DEBUG(PSTR(" of "));
+				    DEBUG(conditionPasses);
+				    DEBUG(PSTR(" flips: "));
+				    DEBUG(menu.conditionFlips);
+				    DEBUG_NL();
+				    break;
+
+			   case 'K':
+				   scheduler.resetStats();
+				   conditionPasses = conditionUpdates = 0;
+				   menu.conditionFlips = 0;
+				   break;
+
+			   case 'j': // frame timing stats (binary, timing_stats)
+				   for(uint16_t i = 0; i < sizeof(timer.timing); i++)
+				   {
+					   VirtualSerial_PutChar(((char *) &timer.timing)[i]);
+				   }
+				   break;
+
+			   case 'J':
+				   timer.resetTiming();
+				   break;
+
 			   case 'B':
 				   bt.init();
 				   break;
@@ -387,45 +551,14 @@ int main()
 		   Tasks
 		*****************************/
 
-		updateConditions();
-		menu.task();
-		timer.task();
-		clock.task();
-		bt.task();
-		notify.task();
-		light.task();
-
-		if(USBmode == 1)
-			PTP_Task();
-		else
-			VirtualSerial_Task();
-
-
-		/****************************
-		   Events / Notifications
-		*****************************/
-		
-		count++;
-		if(count > 5)
-		{
-			count = 0;
-			charge_status = battery_status();
-			camera.checkEvent();
-		}
-
-		if(bt.event) remote.event();
-
-		if(menu.unusedKey == FR_KEY)
-			hardware_flashlight_toggle();
+		scheduler.run();
 
-
-		static uint32_t startTime = 0;
-
-		if(clock.Ms() > startTime + 60000)
-		{
-			startTime = clock.Ms();
-			battery_percent = battery_read();
-		}
+		clock.idleOk = USBmode == 0 && charge_status == 0 && bt.state != BT_ST_CONNECTED && bt.state != BT_ST_CONNECTED_NMX;
+		// power-down stops the USART, edge interrupts and SPI, so only with BT asleep, no lightning trigger armed
+		// and no LCD frame going out
+		clock.deepOk = clock.idleOk && bt.state == BT_ST_SLEEP && !timer.running && lcd.getBacklight() == 0
+			&& !hardware_flashlightIsOn() && !(EIMSK & _BV(INT6)) && !lcd.busy();
+		clock.idle();
 
 		if((hardware_USB_HostConnected || connectUSBcamera) && (USBmode == 0))
 		{
@@ -446,6 +579,137 @@ int main()
 	}
 }
 
+/******************************************************************
+ *
+ *   Main loop tasks
+ *   Run by the scheduler, see main()
+ *
+ ******************************************************************/
+
+void shutterTask()
+{
+	timer.task();
+}
+
+void clockTask()
+{
+	clock.task();
+}
+
+void buttonTask()
+{
+	button.task();
+}
+
+void usbTask()
+{
+	if(USBmode == 1)
+	{
+		if(!clock.bulbBusy()) PTP_Task(); // the bulb ISR may run a PTP transaction
+	}
+	else
+		VirtualSerial_Task();
+}
+
+void btTask()
+{
+	bt.task();
+	if(bt.event) remote.event();
+}
+
+void cameraTask()
+{
+	camera.pollTask();
+}
+
+void lightTask()
+{
+	light.task();
+}
+
+void uiTask()
+{
+	static uint8_t saves;
+
+	updateConditions();
+	menu.task();
+
+	if(menu.saves != saves) // edit screens write timer.current and conf directly
+	{
+		saves = menu.saves;
+		notify.changed(WATCH_PROGRAM);
+		notify.changed(WATCH_CAMERA_FPS);
+		notify.changed(WATCH_CAMERA_MAKE);
+	}
+
+	if(menu.unusedKey == FR_KEY)
+		hardware_flashlight_toggle();
+}
+
+void lcdTask()
+{
+	lcd.task();
+}
+
+#ifdef LCD_MIRROR_ENABLED
+int8_t lcdMirrorPut(uint8_t b)
+{
+	static uint32_t stalledSince;
+	int8_t ret = USBmode == 0 ? VirtualSerial_TryPutChar((char)b) : -1;
+
+	if(ret != 0)
+	{
+		stalledSince = 0;
+	}
+	else if(stalledSince == 0)
+	{
+		stalledSince = clock.Ms() | 1;
+	}
+	else if(clock.Ms() - stalledSince > LCD_MIRROR_STALL_MS) // port open but nobody reading
+	{
+		stalledSince = 0;
+		ret = -1;
+	}
+
+	return ret;
+}
+#endif
+
+void notifyTask()
+{
+	notify.task();
+}
+
+void remoteTask()
+{
+	remote.notifyTask();
+}
+
+void chargeTask()
+{
+	uint8_t s = battery_status_poll();
+	if(s != charge_status)
+	{
+		charge_status = s;
+		notify.changed(WATCH_CHARGE);
+	}
+}
+
+void batteryTask()
+{
+	uint8_t p = battery_read();
+	if(p != battery_percent)
+	{
+		battery_percent = p;
+		notify.changed(WATCH_BATTERY);
+	}
+}
+
+void energyTask()
+{
+	energy.task();
+}
+
 void message_notify(uint8_t id)
 {
 	switch(id)
@@ -514,16 +778,76 @@ void message_notify(uint8_t id)
  *
  *   ISR
  * 
- *   Timer2 interrupt routine - called every millisecond
- *   Configured in hardware.cpp hardware_init()
+ *   Timer3 compare B - system tick, every millisecond unless
+ *   stretched while idle
+ *   Configured in clock.cpp Clock::init()
  *
  ******************************************************************/
 
-ISR(TIMER2_COMPA_vect)
+ISR(TIMER3_COMPB_vect)
 {
+	uint16_t start = TCNT3;
+
 	clock.count();
-	button.poll();
-    if(PTP_Run_Task) USB_USBTask();
+	button.sample();
+
+	clock.tickUs = TCNT3 - start;
+	if(clock.tickUs > clock.tickUsMax) clock.tickUsMax = clock.tickUs;
+}
+
+/******************************************************************
+ *
+ *   ISR
+ * 
+ *   INT4 - FL key edge, or the low level that ends a power-down
+ *   Configured in button.cpp
+ *
+ ******************************************************************/
+
+ISR(INT4_vect)
+{
+	button.sample();
+}
+
+/******************************************************************
+ *
+ *   ISR
+ * 
+ *   Watchdog - wakes Clock::deepSleep
+ *
+ ******************************************************************/
+
+ISR(WDT_vect)
+{
+	clock.wdtWake();
+}
+
+/******************************************************************
+ *
+ *   ISR
+ * 
+ *   ADC conversion complete
+ *   Configured in adc.cpp
+ *
+ ******************************************************************/
+
+ISR(ADC_vect)
+{
+	adc_complete();
+}
+
+/******************************************************************
+ *
+ *   ISR
+ * 
+ *   Timer3 compare match - bulb start and end
+ *   Configured in clock.cpp Clock::bulb()
+ *
+ ******************************************************************/
+
+ISR(TIMER3_COMPA_vect)
+{
+	clock.bulbCompare();
 }
 
 /******************************************************************
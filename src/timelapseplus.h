@@ -30,6 +30,23 @@
 
 int main();
 void setup(void);
+void schedule(void (*func)(), const char *name, uint8_t priority, uint16_t period, uint16_t deadline);
 
 void message_notify(uint8_t id);
 
+void shutterTask(void);
+void clockTask(void);
+void buttonTask(void);
+void usbTask(void);
+void btTask(void);
+void cameraTask(void);
+void lightTask(void);
+void uiTask(void);
+void lcdTask(void);
+int8_t lcdMirrorPut(uint8_t b);
+void notifyTask(void);
+void remoteTask(void);
+void chargeTask(void);
+void batteryTask(void);
+void energyTask(void);
+
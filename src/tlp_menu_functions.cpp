@@ -29,46 +29,10 @@
 #include "remote.h"
 #include "light.h"
 #include "nmx.h"
+#include "energy.h"
+#include "notify.h"
 #include "tlp_menu_functions.h"
 
-volatile uint8_t showGap = 0;
-volatile uint8_t timerNotRunning = 1;
-volatile uint8_t modeHDR = 0;
-volatile uint8_t modeTimelapse = 1;
-volatile uint8_t modeStandard = 1;
-volatile uint8_t modeStandardExp = 1;
-volatile uint8_t modeStandardExpNikon = 0;
-volatile uint8_t modeStandardExpArb = 0;
-volatile uint8_t modeRamp = 0;
-volatile uint8_t modeRampNormal = 0;
-volatile uint8_t modeRampExtended = 0;
-volatile uint8_t modeNoRamp = 1;
-volatile uint8_t modeRampKeyAdd = 0;
-volatile uint8_t modeRampKeyDel = 0;
-volatile uint8_t modeBulb = 0;
-volatile uint8_t bulb1 = 0;
-volatile uint8_t bulb2 = 0;
-volatile uint8_t bulb3 = 0;
-volatile uint8_t bulb4 = 0;
-volatile uint8_t bulb5 = 0;
-volatile uint8_t bulb6 = 0;
-volatile uint8_t bulb7 = 0;
-volatile uint8_t bulb8 = 0;
-volatile uint8_t bulb9 = 0;
-volatile uint8_t showRemoteStart = 0;
-volatile uint8_t showRemoteInfo = 0;
-volatile uint8_t brampKeyframe = 0;
-volatile uint8_t brampGuided = 0;
-volatile uint8_t brampAuto = 0;
-volatile uint8_t showIntervalMaxMin = INTERVAL_MODE_FIXED;
-volatile uint8_t rampISO = 0;
-volatile uint8_t rampAperture = 0;
-volatile uint8_t rampTargetCustom = 0;
-
-volatile uint8_t brampNotAuto = 0;
-volatile uint8_t brampNotGuided = 0;
-
-volatile uint8_t cameraMakeNikon = 0;
 
 extern uint8_t battery_percent;
 extern settings_t conf;
@@ -85,9 +49,25 @@ extern IR ir;
 extern Remote remote;
 extern PTP camera;
 extern Light light;
+extern Energy energy;
+extern Notify notify;
 
 uint8_t sleepOk = 1;
 
+// Everything the menu conditions are computed from, compared each pass //
+struct condition_inputs_t
+{
+	uint16_t mode, brampMethod, keyframes, photos, intervalMode, gap, gapMin;
+	uint8_t nightMode;
+	uint8_t cameraMake, arbitraryBulb, extendedRamp, brampMode;
+	uint8_t iso, aperture, video, focus;
+	uint8_t remoteConnected, remoteRunning, remoteModel;
+	uint8_t underThreshold;
+	int8_t currentId;
+};
+
+uint32_t conditionPasses, conditionUpdates;
+
 #include "Menu_Map.h"
 
 
@@ -101,53 +81,102 @@ uint8_t sleepOk = 1;
 
 void updateConditions()
 {
-	if(timerNotRunning != !timer.running) menu.refresh();
-	timerNotRunning = !timer.running;
-	modeTimelapse = (timer.current.Mode & TIMELAPSE);
-	modeHDR = (timer.current.Mode & HDR);
-	modeStandard = (!modeHDR && !modeRamp);
-
-	modeStandardExp = modeStandard && (conf.camera.cameraMake != NIKON) && !conf.arbitraryBulb;
-	modeStandardExpNikon = modeStandard && (conf.camera.cameraMake == NIKON) && !conf.arbitraryBulb;
-	modeStandardExpArb = modeStandard && conf.arbitraryBulb;
-
-	modeRamp = (timer.current.Mode & RAMP);
-	modeRampNormal = modeRamp && !conf.extendedRamp;
-	modeRampExtended = modeRamp && conf.extendedRamp;
-	modeNoRamp = !modeRamp && modeTimelapse;
-	brampAuto = timer.current.brampMethod == BRAMP_METHOD_AUTO && modeRamp;
-	brampGuided = timer.current.brampMethod == BRAMP_METHOD_GUIDED && modeRamp;
-	brampKeyframe = timer.current.brampMethod == BRAMP_METHOD_KEYFRAME && modeRamp;
-	modeRampKeyAdd = (brampKeyframe && (timer.current.Keyframes < MAX_KEYFRAMES));
-	modeRampKeyDel = (brampKeyframe && (timer.current.Keyframes > 1));
-	bulb1 = timer.current.Keyframes > 1 && brampKeyframe;
-	bulb2 = timer.current.Keyframes > 2 && brampKeyframe;
-	bulb3 = timer.current.Keyframes > 3 && brampKeyframe;
-	bulb4 = timer.current.Keyframes > 4 && brampKeyframe;
-	bulb5 = timer.current.Keyframes > 5 && brampKeyframe;
-	bulb6 = timer.current.Keyframes > 6 && brampKeyframe;
-	bulb7 = timer.current.Keyframes > 7 && brampKeyframe;
-	bulb8 = timer.current.Keyframes > 8 && brampKeyframe;
-	bulb9 = timer.current.Keyframes > 9 && brampKeyframe;
-	showGap = timer.current.Photos != 1 && modeTimelapse && (timer.current.IntervalMode == INTERVAL_MODE_FIXED || modeNoRamp);
-	showIntervalMaxMin = timer.current.Photos != 1 && modeTimelapse && modeRamp && timer.current.IntervalMode == INTERVAL_MODE_AUTO;
-	showRemoteStart = (remote.connected && !remote.running && remote.model == REMOTE_MODEL_TLP);	
-	showRemoteInfo = (remote.connected && (remote.model == REMOTE_MODEL_TLP || remote.model == REMOTE_MODEL_IPHONE));
-	clock.sleepOk = timerNotRunning && !timer.cableIsConnected() && bt.state != BT_ST_CONNECTED && bt.state != BT_ST_CONNECTED_NMX && sleepOk;
-	brampNotGuided = modeRamp && !brampGuided;
-	brampNotAuto = modeRamp && !brampAuto && !light.underThreshold;
-	rampISO = (conf.brampMode & BRAMP_MODE_ISO && camera.supports.iso);
-	rampAperture = (conf.brampMode & BRAMP_MODE_APERTURE && camera.supports.aperture);
-	rampTargetCustom = (timer.current.nightMode == BRAMP_TARGET_CUSTOM && brampAuto);
-	cameraMakeNikon = conf.camera.cameraMake == NIKON;
+	static condition_inputs_t last;
+	static uint8_t primed;
+	condition_inputs_t in;
+
+	if(!primed || menu.condition(COND_TIMER_NOT_RUNNING) != !timer.running)
+	{
+		menu.setCondition(COND_TIMER_NOT_RUNNING, !timer.running);
+		menu.setCondition(COND_TIMER_RUNNING, timer.running);
+		if(primed) menu.refresh();
+	}
+	clock.sleepOk = !timer.running && !timer.cableIsConnected() && bt.state != BT_ST_CONNECTED && bt.state != BT_ST_CONNECTED_NMX && sleepOk;
+
+	conditionPasses++;
+
+	in.mode = timer.current.Mode;
+	in.brampMethod = timer.current.brampMethod;
+	in.keyframes = timer.current.Keyframes;
+	in.photos = timer.current.Photos;
+	in.intervalMode = timer.current.IntervalMode;
+	in.gap = timer.current.Gap;
+	in.gapMin = timer.current.GapMin;
+	in.nightMode = timer.current.nightMode;
+	in.cameraMake = conf.camera.cameraMake;
+	in.arbitraryBulb = conf.arbitraryBulb;
+	in.extendedRamp = conf.extendedRamp;
+	in.brampMode = conf.brampMode;
+	in.iso = camera.supports.iso;
+	in.aperture = camera.supports.aperture;
+	in.video = camera.supports.video;
+	in.focus = camera.supports.focus;
+	in.remoteConnected = remote.connected;
+	in.remoteRunning = remote.running;
+	in.remoteModel = remote.model;
+	in.underThreshold = light.underThreshold;
+	in.currentId = timer.currentId;
+
+	if(primed && memcmp(&in, &last, sizeof(in)) == 0) return; // nothing the conditions depend on has changed
+	last = in;
+	primed = 1;
+	conditionUpdates++;
+
+	uint8_t modeTimelapse = (timer.current.Mode & TIMELAPSE) != 0;
+	uint8_t modeHDR = (timer.current.Mode & HDR) != 0;
+	uint8_t modeRamp = (timer.current.Mode & RAMP) != 0;
+	uint8_t modeStandard = !modeHDR && !modeRamp;
+	uint8_t modeNoRamp = !modeRamp && modeTimelapse;
+	uint8_t nikon = conf.camera.cameraMake == NIKON;
+	uint8_t brampKeyframe = timer.current.brampMethod == BRAMP_METHOD_KEYFRAME && modeRamp;
+	uint8_t brampGuided = timer.current.brampMethod == BRAMP_METHOD_GUIDED && modeRamp;
+	uint8_t brampAuto = timer.current.brampMethod == BRAMP_METHOD_AUTO && modeRamp;
+
+	menu.setCondition(COND_MODE_TIMELAPSE, modeTimelapse);
+	menu.setCondition(COND_MODE_HDR, modeHDR);
+	menu.setCondition(COND_MODE_STANDARD, modeStandard);
+
+	menu.setCondition(COND_MODE_STANDARD_EXP, modeStandard && !nikon && !conf.arbitraryBulb);
+	menu.setCondition(COND_MODE_STANDARD_EXP_NIKON, modeStandard && nikon && !conf.arbitraryBulb);
+	menu.setCondition(COND_MODE_STANDARD_EXP_ARB, modeStandard && conf.arbitraryBulb);
+
+	menu.setCondition(COND_MODE_RAMP, modeRamp);
+	menu.setCondition(COND_MODE_RAMP_NORMAL, modeRamp && !conf.extendedRamp);
+	menu.setCondition(COND_MODE_RAMP_EXTENDED, modeRamp && conf.extendedRamp);
+	menu.setCondition(COND_MODE_NO_RAMP, modeNoRamp);
+	menu.setCondition(COND_BRAMP_AUTO, brampAuto);
+	menu.setCondition(COND_BRAMP_GUIDED, brampGuided);
+	menu.setCondition(COND_BRAMP_KEYFRAME, brampKeyframe);
+	menu.setCondition(COND_MODE_RAMP_KEY_ADD, brampKeyframe && timer.current.Keyframes < MAX_KEYFRAMES);
+	menu.setCondition(COND_MODE_RAMP_KEY_DEL, brampKeyframe && timer.current.Keyframes > 1);
+	for(uint8_t i = 1; i <= 9; i++)
+	{
+		menu.setCondition(COND_BULB1 - 1 + i, timer.current.Keyframes > i && brampKeyframe);
+	}
+	menu.setCondition(COND_SHOW_GAP, timer.current.Photos != 1 && modeTimelapse && (timer.current.IntervalMode == INTERVAL_MODE_FIXED || modeNoRamp));
+	menu.setCondition(COND_SHOW_INTERVAL_MAX_MIN, timer.current.Photos != 1 && modeTimelapse && modeRamp && timer.current.IntervalMode == INTERVAL_MODE_AUTO);
+	menu.setCondition(COND_SHOW_REMOTE_START, remote.connected && !remote.running && remote.model == REMOTE_MODEL_TLP);
+	menu.setCondition(COND_SHOW_REMOTE_INFO, remote.connected && (remote.model == REMOTE_MODEL_TLP || remote.model == REMOTE_MODEL_IPHONE));
+	menu.setCondition(COND_BRAMP_NOT_GUIDED, modeRamp && !brampGuided);
+	menu.setCondition(COND_BRAMP_NOT_AUTO, modeRamp && !brampAuto && !light.underThreshold);
+	menu.setCondition(COND_RAMP_ISO, (conf.brampMode & BRAMP_MODE_ISO) && camera.supports.iso);
+	menu.setCondition(COND_RAMP_APERTURE, (conf.brampMode & BRAMP_MODE_APERTURE) && camera.supports.aperture);
+	menu.setCondition(COND_RAMP_TARGET_CUSTOM, timer.current.nightMode == BRAMP_TARGET_CUSTOM && brampAuto);
+	menu.setCondition(COND_CAMERA_MAKE_NIKON, nikon);
+	menu.setCondition(COND_PROGRAM_LOADED, timer.currentId != 0);
+	menu.setCondition(COND_CAMERA_VIDEO, camera.supports.video);
+	menu.setCondition(COND_CAMERA_FOCUS, camera.supports.focus);
+
 	if(modeRamp && timer.current.Gap < BRAMP_INTERVAL_MIN)
 	{
 		timer.current.Gap = BRAMP_INTERVAL_MIN;
+		notify.changed(WATCH_PROGRAM);
 		menu.refresh();
 	}
 	if(modeRamp && (timer.current.GapMin < BRAMP_INTERVAL_VAR_MIN))
 	{
 		timer.current.GapMin = BRAMP_INTERVAL_VAR_MIN;
+		notify.changed(WATCH_PROGRAM);
 		menu.refresh();
 	}
 }
@@ -1021,6 +1050,29 @@ volatile char viewSeconds(char key, char first)
 	return FN_CONTINUE;
 }
 
+/******************************************************************
+ *
+ *   tenthsValue
+ *
+ *   appends n/10 with one decimal (none from 100 up)
+ *
+ ******************************************************************/
+
+static void tenthsValue(char *text, uint16_t tenths)
+{
+	char buf[6];
+
+	int_to_str(tenths / 10, buf);
+	strcat(text, buf);
+	if(tenths < 1000)
+	{
+		buf[0] = '.';
+		buf[1] = (char)('0' + tenths % 10);
+		buf[2] = '\0';
+		strcat(text, buf);
+	}
+}
+
 /******************************************************************
  *
  *   getChargingStatus
@@ -1086,7 +1138,22 @@ volatile char batteryStatus(char key, char first)
 	char l = lcd.measureStringTiny(text) / 2;
 
 	if(battery_status())
+	{
 		lcd.writeStringTiny(41 - l, 31, text);
+	}
+	else if(energy.ledger.batteryMinutes)
+	{
+		char buf[20];
+		float ma = energy.ledger.avgMa * 10.0;
+
+		buf[0] = '\0';
+		tenthsValue(buf, ma > 65535.0 ? 65535 : (uint16_t)ma);
+		strcat(buf, STR("mA, "));
+		tenthsValue(buf, energy.ledger.batteryMinutes / 6);
+		strcat(buf, STR("h left"));
+		l = lcd.measureStringTiny(buf) / 2;
+		lcd.writeStringTiny(41 - l, 31, buf);
+	}
 
 	// Draw Battery Outline //
 	lcd.drawLine(20, 15, 60, 15);
@@ -1129,13 +1196,29 @@ volatile char batteryStatus(char key, char first)
 volatile char sysStatus(char key, char first)
 {
 	char* text;
+	static uint8_t showEnergy;
 
 	if(first)
 	{
+		showEnergy = 0;
 	}
+	if(key == UP_KEY || key == DOWN_KEY) showEnergy = !showEnergy;
 
 	lcd.cls();
 
+	if(showEnergy)
+	{
+		displayEnergy();
+		menu.setTitle(TEXT("Energy"));
+		menu.setBar(TEXT("RETURN"), BLANK_STR);
+		lcd.update();
+
+		if(key == FL_KEY || key == LEFT_KEY)
+			return FN_CANCEL;
+
+		return FN_CONTINUE;
+	}
+
 	text = getChargingStatus();
 
 	char l = lcd.measureStringTiny(text);
@@ -1192,16 +1275,53 @@ volatile char sysStatus(char key, char first)
  *
  ******************************************************************/
 
+#define TIMING_PAGE_SECONDS 10
+
 volatile char timerStatus(char key, char first)
 {
 	//static uint8_t counter;
+	static uint8_t showTiming;
+	static uint32_t timingKeyTime;
 
-	if(modeRamp)
+	if(first) showTiming = 0;
+
+	if(menu.condition(COND_MODE_RAMP))
 	{
-		return bramp_monitor(key, first);
+		// UP/DOWN adjust the ramp here, so RIGHT flips to the timing page instead.  It goes back to
+		// the monitor on its own after a while, so the monitor can dim the screen and resume metering //
+		if(!showTiming)
+		{
+			if(key != RIGHT_KEY || !light.paused || timer.status.preChecked != 0) return bramp_monitor(key, first);
+			showTiming = 1;
+			timingKeyTime = clock.Seconds();
+			key = 0;
+		}
+
+		if(key) timingKeyTime = clock.Seconds();
+		if(key == RIGHT_KEY || key == LEFT_KEY || key == FR_KEY || !timer.running || clock.Seconds() - timingKeyTime > TIMING_PAGE_SECONDS)
+		{
+			showTiming = 0;
+			return bramp_monitor(0, 1);
+		}
+
+		lcd.cls();
+		displayTimingStats();
+		menu.setTitle(TEXT("ms avg/p99"));
+		menu.setBar(TEXT("OPTIONS"), TEXT("RETURN"));
+		lcd.update();
+
+		if(key == FL_KEY)
+		{
+			menu.push(1);
+			menu.submenu((void*)menu_timelapse_options);
+		}
+
+		return FN_CONTINUE;
 	}
 	else
 	{
+		if(key == UP_KEY || key == DOWN_KEY) showTiming = !showTiming;
+
 		//if(first)
 		//{
 		//	counter = 0;
@@ -1212,9 +1332,16 @@ volatile char timerStatus(char key, char first)
 			//counter = 0;
 			lcd.cls();
 
-			displayTimerStatus(0);
-
-			menu.setTitle(TEXT("Running"));
+			if(showTiming)
+			{
+				displayTimingStats();
+				menu.setTitle(TEXT("ms avg/p99"));
+			}
+			else
+			{
+				displayTimerStatus(0);
+				menu.setTitle(TEXT("Running"));
+			}
 			menu.setBar(TEXT("OPTIONS"), TEXT("STOP"));
 			lcd.update();
 		//}
@@ -1386,6 +1513,134 @@ void displayTimerStatus(uint8_t remote_system)
 
 }
 
+/******************************************************************
+ *
+ *   timingValue
+ *
+ *   ms, or whole seconds once it won't fit
+ *
+ ******************************************************************/
+
+static void timingValue(char *text, int32_t val)
+{
+	char buf[6];
+
+	if(val < 0)
+	{
+		strcat(text, STR("-"));
+		val = 0 - val;
+	}
+	if(val >= 10000)
+	{
+		int_to_str((uint16_t)(val / 1000 > 9999 ? 9999 : val / 1000), buf);
+		strcat(buf, STR("s"));
+	}
+	else
+	{
+		int_to_str((uint16_t)val, buf);
+	}
+	strcat(text, buf);
+}
+
+/******************************************************************
+ *
+ *   displayTimingStats
+ *
+ *   mean/p99 of each frame timing stat
+ *
+ ******************************************************************/
+
+void displayTimingStats(void)
+{
+	char text[16], l;
+	timing_stat *stat[3] = { &timer.timing.start, &timer.timing.bulb, &timer.timing.dead };
+
+	for(uint8_t i = 0; i < 3; i++)
+	{
+		text[0] = '\0';
+		if(stat[i]->count)
+		{
+			timingValue(text, (int32_t)stat[i]->mean);
+			strcat(text, STR("/"));
+			timingValue(text, (int32_t)timingStatP99(stat[i]));
+		}
+		else
+		{
+			strcpy(text, STR("--"));
+		}
+		l = lcd.measureStringTiny(text);
+		lcd.writeStringTiny(80 - l, 6 + i * 6 + SY, text);
+	}
+	lcd.writeStringTiny(3, 6 + SY, PTEXT("Start:"));
+	lcd.writeStringTiny(3, 12 + SY, PTEXT("Bulb:"));
+	lcd.writeStringTiny(3, 18 + SY, PTEXT("Dead time:"));
+
+	text[0] = '\0';
+	timingValue(text, timer.timing.start.max);
+	l = lcd.measureStringTiny(text);
+	lcd.writeStringTiny(80 - l, 24 + SY, text);
+	lcd.writeStringTiny(3, 24 + SY, PTEXT("Worst start:"));
+
+	int_to_str(timer.timing.start.count, text);
+	l = lcd.measureStringTiny(text);
+	lcd.writeStringTiny(80 - l, 30 + SY, text);
+	lcd.writeStringTiny(3, 30 + SY, PTEXT("Frames:"));
+}
+
+/******************************************************************
+ *
+ *   displayEnergy
+ *
+ *   draw, projected run time and charge used per consumer
+ *
+ ******************************************************************/
+
+void displayEnergy(void)
+{
+	char text[20], buf[6], l;
+	float ma = energy.ledger.avgMa * 10.0;
+
+	text[0] = '\0';
+	tenthsValue(text, ma > 65535.0 ? 65535 : (uint16_t)ma);
+	l = lcd.measureStringTiny(text);
+	lcd.writeStringTiny(80 - l, 6 + SY, text);
+	lcd.writeStringTiny(3, 6 + SY, PTEXT("Draw mA:"));
+
+	text[0] = '\0';
+	tenthsValue(text, energy.ledger.batteryMinutes / 6);
+	l = lcd.measureStringTiny(text);
+	lcd.writeStringTiny(80 - l, 12 + SY, text);
+	lcd.writeStringTiny(3, 12 + SY, PTEXT("Battery h:"));
+
+	text[0] = '\0';
+	if(energy.ledger.programMinutes)
+		tenthsValue(text, energy.ledger.programMinutes / 6);
+	else
+		strcpy(text, STR("--"));
+	l = lcd.measureStringTiny(text);
+	lcd.writeStringTiny(80 - l, 18 + SY, text);
+	lcd.writeStringTiny(3, 18 + SY, PTEXT("Program h:"));
+
+	int_to_str((uint16_t)(energy.mAh(ENERGY_CPU_RUN) + energy.mAh(ENERGY_CPU_IDLE) + energy.mAh(ENERGY_CPU_DOWN)), text);
+	strcat(text, STR("/"));
+	int_to_str((uint16_t)energy.mAh(ENERGY_LIGHT), buf);
+	strcat(text, buf);
+	l = lcd.measureStringTiny(text);
+	lcd.writeStringTiny(80 - l, 24 + SY, text);
+	lcd.writeStringTiny(3, 24 + SY, PTEXT("CPU/Light mAh:"));
+
+	int_to_str((uint16_t)energy.mAh(ENERGY_BACKLIGHT), text);
+	strcat(text, STR("/"));
+	int_to_str((uint16_t)energy.mAh(ENERGY_BT), buf);
+	strcat(text, buf);
+	strcat(text, STR("/"));
+	int_to_str((uint16_t)energy.mAh(ENERGY_USB_HOST), buf);
+	strcat(text, buf);
+	l = lcd.measureStringTiny(text);
+	lcd.writeStringTiny(80 - l, 30 + SY, text);
+	lcd.writeStringTiny(3, 30 + SY, PTEXT("BL/BT/USB:"));
+}
+
 /******************************************************************
  *
  *   sysInfo
@@ -1824,14 +2079,14 @@ volatile char focusStack(char key, char first)
 
 	if(photosTaken >= photos)
 	{
-		if(cameraMakeNikon) camera.liveView(false);	
+		if(menu.condition(COND_CAMERA_MAKE_NIKON)) camera.liveView(false);	
 		menu.message(TEXT("Done!"));
 		photosTaken = 0;
 		first = 1;
 		state = 1;
 	}
 
-	if(!camera.modeLiveView && !cameraMakeNikon)
+	if(!camera.modeLiveView && !menu.condition(COND_CAMERA_MAKE_NIKON))
 	{
 		if(first || state > 0)
 		{
@@ -1975,7 +2230,7 @@ volatile char focusStack(char key, char first)
 	}
 	if(state == 7) // Running
 	{
-		if(cameraMakeNikon) camera.liveView(true);
+		if(menu.condition(COND_CAMERA_MAKE_NIKON)) camera.liveView(true);
 
 		float percent = (float) photosTaken /  (float) photos;
 		uint8_t bar = (uint8_t) (56.0 * percent) + 12;
@@ -2047,13 +2302,13 @@ volatile char focusStack(char key, char first)
 
 	if(key == FR_KEY && state == 7)
 	{
-		if(cameraMakeNikon) camera.liveView(false);	
+		if(menu.condition(COND_CAMERA_MAKE_NIKON)) camera.liveView(false);	
 		menu.message(TEXT("Cancelled"));
 		state = 1;
 	}
 	if(key == FL_KEY && state < 7)
 	{
-		if(cameraMakeNikon) camera.liveView(false);	
+		if(menu.condition(COND_CAMERA_MAKE_NIKON)) camera.liveView(false);	
 		state = 0;
 		//camera.liveView(false);
 		return FN_CANCEL;
@@ -2520,7 +2775,10 @@ volatile char btFloodTest(char key, char first)
 volatile char timerStop(char key, char first)
 {
 	if(first)
+	{
 		timer.running = 0;
+		notify.changed(WATCH_RUNNING);
+	}
 
 	light.paused = 1;
 	menu.message(TEXT("Stopped"));
@@ -2596,6 +2854,7 @@ volatile char timerSaveDefault(char key, char first)
 		timer.current.Name[6] = 'T';
 		timer.current.Name[7] = '\0';
 		timer.save(0);
+		notify.changed(WATCH_PROGRAM);
 	}
 
 	menu.message(TEXT("Saved"));
@@ -2655,6 +2914,7 @@ volatile char shutter_addKeyframe(char key, char first)
 		timer.current.Key[timer.current.Keyframes] = timer.current.Key[timer.current.Keyframes - 1] + 3600;
 		timer.current.Bulb[timer.current.Keyframes + 1] = timer.current.Bulb[timer.current.Keyframes];
 		timer.current.Keyframes++;
+		notify.changed(WATCH_PROGRAM);
 	}
 
 	menu.back();
@@ -2674,6 +2934,7 @@ volatile char shutter_removeKeyframe(char key, char first)
 	if(timer.current.Keyframes > 1)
 	{
 		timer.current.Keyframes--;
+		notify.changed(WATCH_PROGRAM);
 	}
 
 	menu.back();
@@ -2712,6 +2973,7 @@ volatile char shutter_saveAs(char key, char first)
 		name[MENU_NAME_LEN - 2] = 0;
 		strcpy((char*)timer.current.Name, name);
 		timer.save(newId);
+		notify.changed(WATCH_PROGRAM);
 		for(uint8_t i = 0; i < MENU_NAME_LEN - 1; i++) name[i] = 0;
 		menu.message(TEXT("Saved"));
 		menu.back();
@@ -2985,7 +3247,10 @@ volatile char bramp_monitor(char key, char first)
 
 	#define LOCK_AFTER 4
 
-    static uint8_t rampHistory[CHART_X_SPAN], skip_message = 0;
+    static uint8_t rampHistory[CHART_X_SPAN], skip_message = 0, redraw = 1;
+    static int8_t keyChart[CHART_X_SPAN], keyChartMin, keyChartMax;
+    static uint8_t keyChartValid;
+    static uint8_t chartFrom, chartMethod; // columns left of chartFrom are final (history, progress) and kept
     static uint32_t lock_time;
 
     if(clock.Seconds() - lock_time > LOCK_AFTER && !timer.paused && timer.status.preChecked == 0)
@@ -3003,6 +3268,8 @@ volatile char bramp_monitor(char key, char first)
 	uint8_t waiting = strcmp(timer.status.textStatus, STR("Delay")) == 0;
 	if(timer.status.preChecked == 0)
 	{
+	  if(first || redraw) // static chrome, kept between passes unless a message box covered it
+	  {
 		lcd.cls();
 
 		lcd.writeStringTiny(2, 1, PTEXT("BULB RAMP"));
@@ -3030,6 +3297,25 @@ volatile char bramp_monitor(char key, char first)
 		lcd.drawLine(32, 8, 32, 14);
 		lcd.drawLine(33, 9, 33, 14);
 
+		keyChartValid = 0;
+		chartFrom = CHART_X_TOP - 1;
+		redraw = 0;
+	  }
+	  else // clear just the fields redrawn below //
+	  {
+		lcd.eraseBox(1, 7, 27, 15);		// ramp rate
+		lcd.eraseBox(34, 8, 52, 15);	// battery level
+		lcd.eraseBox(54, 1, 60, 40);	// interval bar
+		lcd.eraseBox(62, 1, 82, 19);	// aperture, shutter, ISO
+		lcd.eraseBox(62, 21, 82, 27);	// ramp stops
+		lcd.eraseBox(62, 30, 82, 40);	// photos
+		if(waiting || chartMethod != timer.current.brampMethod || (timer.current.brampMethod == BRAMP_METHOD_KEYFRAME &&
+			(keyChartMin != timer.status.rampMin || keyChartMax != timer.status.rampMax))) chartFrom = CHART_X_TOP - 1;
+		lcd.eraseBox(chartFrom, 17, 53, 40);	// chart and progress right of the final columns
+		lcd.drawLine(53, 17, 53, 40);
+	  }
+	  chartMethod = timer.current.brampMethod;
+
 		int16_t b = (uint16_t)battery_percent;
 		if(b > 99) b = 99;
 		buf[1] = b % 10 + '0';
@@ -3176,71 +3462,85 @@ volatile char bramp_monitor(char key, char first)
 
 
 
-		// Plot Chart //
+		// Plot Chart, from the first column that isn't final //
+		uint8_t xFrom = chartFrom > CHART_X_TOP ? chartFrom - CHART_X_TOP : 0, xFinal = CHART_X_SPAN;
+		float colMinutes = (float)timer.current.Duration / (float)CHART_X_SPAN;
+
 		if(timer.current.brampMethod == BRAMP_METHOD_KEYFRAME)
 		{
-			for(uint8_t x = 0; x < CHART_X_SPAN; x++)
+			if(!keyChartValid || keyChartMin != timer.status.rampMin || keyChartMax != timer.status.rampMax) // the curve is fixed, so worked out once
 			{
-				uint32_t s = (uint32_t)(((float)timer.current.Duration / (float)CHART_X_SPAN) * (float)x * 60.0); //J.R.
-	            float key1 = 1, key2 = 1, key3 = 1, key4 = 1;
-	            char found = 0;
-	            uint8_t i;
-
-	            for(i = 0; i < timer.current.Keyframes; i++)
-	            {
-	                if(s <= timer.current.Key[i])
-	                {
-	                    found = 1;
-	                    if(i == 0)
-	                    {
-	                        key2 = key1 = (float)(timer.current.BulbStart);
-	                    }
-	                    else if(i == 1)
-	                    {
-	                        key1 = (float)(timer.current.BulbStart);
-	                        key2 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i - 1]));
-	                    }
-	                    else
-	                    {
-	                        key1 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i - 2]));
-	                        key2 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i - 1]));
-	                    }
-	                    key3 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i]));
-	                    key4 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i < (timer.current.Keyframes - 1) ? i + 1 : i]));
-	                    break;
-	                }
-	            }
+				keyChartValid = 1;
+				keyChartMin = timer.status.rampMin;
+				keyChartMax = timer.status.rampMax;
+				for(uint8_t x = 0; x < CHART_X_SPAN; x++)
+				{
+					uint32_t s = (uint32_t)(colMinutes * (float)x * 60.0); //J.R.
+		            float key1 = 1, key2 = 1, key3 = 1, key4 = 1;
+		            char found = 0;
+		            uint8_t i;
+
+		            for(i = 0; i < timer.current.Keyframes; i++)
+		            {
+		                if(s <= timer.current.Key[i])
+		                {
+		                    found = 1;
+		                    if(i == 0)
+		                    {
+		                        key2 = key1 = (float)(timer.current.BulbStart);
+		                    }
+		                    else if(i == 1)
+		                    {
+		                        key1 = (float)(timer.current.BulbStart);
+		                        key2 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i - 1]));
+		                    }
+		                    else
+		                    {
+		                        key1 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i - 2]));
+		                        key2 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i - 1]));
+		                    }
+		                    key3 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i]));
+		                    key4 = (float)((int8_t)timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[i < (timer.current.Keyframes - 1) ? i + 1 : i]));
+		                    break;
+		                }
+		            }
 	            
-	            if(found)
-	            {
-	                uint32_t var1 = s;
-	                uint32_t var2 = (i > 0 ? timer.current.Key[i - 1] : 0);
-	                uint32_t var3 = timer.current.Key[i];
-
-	                float t = (float)(var1 - var2) / (float)(var3 - var2);
-	                float curveEv = curve(key1, key2, key3, key4, t);
-	                key1 = (float)timer.current.BulbStart - curveEv;
-	            }
-	            else
-	            {
-	                key1 = (float)((int8_t)(timer.current.BulbStart - (timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[timer.current.Keyframes - 1]))));
-	            }
-
-	            int8_t y = ((((float)key1 - (float)timer.status.rampMin) / (float)(timer.status.rampMax - timer.status.rampMin)) * (float)CHART_Y_SPAN);
-
-				if(y >= 0 && y <= CHART_Y_SPAN) lcd.setPixel(x + CHART_X_TOP, CHART_Y_SPAN + CHART_Y_TOP - y);
+		            if(found)
+		            {
+		                uint32_t var1 = s;
+		                uint32_t var2 = (i > 0 ? timer.current.Key[i - 1] : 0);
+		                uint32_t var3 = timer.current.Key[i];
+
+		                float t = (float)(var1 - var2) / (float)(var3 - var2);
+		                float curveEv = curve(key1, key2, key3, key4, t);
+		                key1 = (float)timer.current.BulbStart - curveEv;
+		            }
+		            else
+		            {
+		                key1 = (float)((int8_t)(timer.current.BulbStart - (timer.current.BulbStart - *((int8_t*)&timer.current.Bulb[timer.current.Keyframes - 1]))));
+		            }
+
+		            int8_t y = ((((float)key1 - (float)timer.status.rampMin) / (float)(timer.status.rampMax - timer.status.rampMin)) * (float)CHART_Y_SPAN);
+
+					keyChart[x] = (y >= 0 && y <= CHART_Y_SPAN) ? y : -1;
+				}
+			}
+
+			for(uint8_t x = xFrom; x < CHART_X_SPAN; x++)
+			{
+				if(keyChart[x] >= 0) lcd.setPixel(x + CHART_X_TOP, CHART_Y_SPAN + CHART_Y_TOP - keyChart[x]);
 			}
 		}
 		else if(timer.current.brampMethod == BRAMP_METHOD_GUIDED || timer.current.brampMethod == BRAMP_METHOD_AUTO)
 		{
 			uint8_t x = 0, x2;
-			uint32_t s, completedS = 0; //J.R.
+			uint32_t s = 0, completedS = 0; //J.R.
 			
 			if(!waiting)
 			{
-				for(x = 0; x < CHART_X_SPAN; x++)
+				for(x = xFrom; x < CHART_X_SPAN; x++)
 				{
-					s = (uint32_t)(((float)timer.current.Duration / (float)CHART_X_SPAN) * (float)x * 60.0); //J.R.
+					s = (uint32_t)(colMinutes * (float)x * 60.0); //J.R.
 
 					if(s >= clock.Seconds()) rampHistory[x] = ((((float)timer.status.rampStops - (float)timer.status.rampMin) / (float)(timer.status.rampMax - timer.status.rampMin)) * (float)CHART_Y_SPAN);
 
@@ -3251,9 +3551,10 @@ volatile char bramp_monitor(char key, char first)
 				completedS = s;
 			}
 			x2 = x;
+			xFinal = x2; // the current column follows rampStops until time moves past it
 			for(x++; x < CHART_X_SPAN; x++)
 			{
-				s = (uint32_t)(((float)timer.current.Duration / (float)CHART_X_SPAN) * (float)x * 60.0); //J.R.
+				s = (uint32_t)(colMinutes * (float)x * 60.0); //J.R.
 
 				s -= completedS;
 
@@ -3274,7 +3575,7 @@ volatile char bramp_monitor(char key, char first)
 			{
 				for(x++; x < CHART_X_SPAN; x += 2)
 				{
-					s = (uint32_t)(((float)timer.current.Duration / (float)CHART_X_SPAN) * (float)x * 60.0); //J.R.
+					s = (uint32_t)(colMinutes * (float)x * 60.0); //J.R.
 
 					s -= completedS;
 
@@ -3296,7 +3597,13 @@ volatile char bramp_monitor(char key, char first)
 			if(timer.running) lastSec = (float)clock.Seconds();
 			uint8_t x = (uint8_t)(((float)lastSec / ((float)timer.current.Duration * 60.0)) * (float)(CHART_X_SPAN + 1));  //J.R.
 			if(x > CHART_X_SPAN + 1) x = CHART_X_SPAN + 1;
-			lcd.drawHighlight(CHART_X_TOP - 1, CHART_Y_TOP - 1, x + CHART_X_TOP, CHART_Y_BOTTOM + 1);
+			lcd.drawHighlight(chartFrom, CHART_Y_TOP - 1, x + CHART_X_TOP, CHART_Y_BOTTOM + 1); // the final columns have it already
+			if(x + 1 < xFinal) xFinal = x + 1;
+			chartFrom = xFinal + CHART_X_TOP;
+		}
+		else
+		{
+			chartFrom = CHART_X_TOP - 1;
 		}
 
 		if(!timer.running)
@@ -3307,6 +3614,7 @@ volatile char bramp_monitor(char key, char first)
 		        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24);
 		        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23);
 		        lcd.writeString(41 - l, 15, timer.status.textStatus);
+		        redraw = 1;
 			}
 			menu.setBar(TEXT("RETURN"), BLANK_STR);
 		}
@@ -3353,6 +3661,7 @@ volatile char bramp_monitor(char key, char first)
 			        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24 + 10);
 			        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23 + 10);
 			        lcd.writeString(41 - l, 15, message_text);
+			        redraw = 1;
 			        stopName(message_text, (0 - timer.apertureEvShift));
 			        l = 8 * 6 / 2;
 			        lcd.writeString(41 - l, 15 + 10, message_text);
@@ -3364,6 +3673,7 @@ volatile char bramp_monitor(char key, char first)
 			        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24);
 			        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23);
 			        lcd.writeString(41 - l, 15, message_text);
+			        redraw = 1;
 				}
 				else
 				{
@@ -3372,6 +3682,7 @@ volatile char bramp_monitor(char key, char first)
 			        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24);
 			        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23);
 			        lcd.writeString(41 - l, 15, message_text);
+			        redraw = 1;
 				}
 			}
 			else if(waiting)
@@ -3384,6 +3695,7 @@ volatile char bramp_monitor(char key, char first)
 		        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24);
 		        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23);
 		        lcd.writeString(41 - l, 15, message_text);
+		        redraw = 1;
 			}
 			else if(timer.pausing)
 			{
@@ -3392,6 +3704,7 @@ volatile char bramp_monitor(char key, char first)
 		        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24);
 		        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23);
 		        lcd.writeString(41 - l, 15, message_text);
+		        redraw = 1;
 			}
 			else if(camera.ready && conf.extendedRamp && !camera.isInBulbMode() && timer.status.bulbLength > camera.bulbTime((int8_t)camera.bulbMin()))
 			{
@@ -3400,6 +3713,7 @@ volatile char bramp_monitor(char key, char first)
 		        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24);
 		        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23);
 		        lcd.writeString(41 - l, 15, message_text);
+		        redraw = 1;
 			}
 			else if(camera.ready && conf.extendedRamp && camera.isInBulbMode() && timer.status.bulbLength <= camera.bulbTime((int8_t)camera.bulbMin()) - camera.bulbTime((int8_t)camera.bulbMin()) / 3)
 			{
@@ -3408,6 +3722,7 @@ volatile char bramp_monitor(char key, char first)
 		        lcd.eraseBox(41 - l - 2, 12, 41 + l + 2, 24);
 		        lcd.drawBox(41 - l - 1, 13, 41 + l + 1, 23);
 		        lcd.writeString(41 - l, 15, message_text);
+		        redraw = 1;
 			}
 		}
 
@@ -3415,6 +3730,8 @@ volatile char bramp_monitor(char key, char first)
 	}
 	else
 	{
+		redraw = 1; // the chart screen is drawn from scratch when we come back to it
+
 	    if(timer.status.preChecked == 2 && (timer.current.Mode & RAMP) && (timer.current.brampMethod == BRAMP_METHOD_AUTO))
 	    {
 			light.paused = 1;
@@ -3574,7 +3891,8 @@ volatile char bramp_monitor(char key, char first)
 	        else if(key == FR_KEY)
 	        {
 				light.paused = 0;
-				timer.status.preChecked = 3;	        	
+				timer.status.preChecked = 3;
+				notify.changed(WATCH_STATUS);	        	
 	        }
 
 	        return FN_CONTINUE;
@@ -3582,6 +3900,7 @@ volatile char bramp_monitor(char key, char first)
 	    else
 	    {
 	        timer.status.preChecked = 3;
+	        notify.changed(WATCH_STATUS);
 	    }
 	}
 
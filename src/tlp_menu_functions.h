@@ -2,6 +2,47 @@
 #define LIGHT_TRIGGER_MODE_RISE 0x01
 #define LIGHT_TRIGGER_MODE_FALL 0x02
 
+// Menu item conditions, bits in menu.conditions kept by updateConditions() //
+#define COND_SHOW_GAP                0
+#define COND_TIMER_NOT_RUNNING       1
+#define COND_MODE_HDR                2
+#define COND_MODE_TIMELAPSE          3
+#define COND_MODE_STANDARD           4
+#define COND_MODE_STANDARD_EXP       5
+#define COND_MODE_STANDARD_EXP_NIKON 6
+#define COND_MODE_STANDARD_EXP_ARB   7
+#define COND_MODE_RAMP               8
+#define COND_MODE_RAMP_NORMAL        9
+#define COND_MODE_RAMP_EXTENDED      10
+#define COND_MODE_NO_RAMP            11
+#define COND_MODE_RAMP_KEY_ADD       12
+#define COND_MODE_RAMP_KEY_DEL       13
+#define COND_BULB1                   14
+#define COND_BULB2                   15
+#define COND_BULB3                   16
+#define COND_BULB4                   17
+#define COND_BULB5                   18
+#define COND_BULB6                   19
+#define COND_BULB7                   20
+#define COND_BULB8                   21
+#define COND_BULB9                   22
+#define COND_SHOW_REMOTE_START       23
+#define COND_SHOW_REMOTE_INFO        24
+#define COND_BRAMP_KEYFRAME          25
+#define COND_BRAMP_GUIDED            26
+#define COND_BRAMP_AUTO              27
+#define COND_BRAMP_NOT_AUTO          28
+#define COND_BRAMP_NOT_GUIDED        29
+#define COND_SHOW_INTERVAL_MAX_MIN   30
+#define COND_RAMP_ISO                31
+#define COND_RAMP_APERTURE           32
+#define COND_RAMP_TARGET_CUSTOM      33
+#define COND_CAMERA_MAKE_NIKON       34
+#define COND_TIMER_RUNNING           35
+#define COND_PROGRAM_LOADED          36
+#define COND_CAMERA_VIDEO            37
+#define COND_CAMERA_FOCUS            38
+
 volatile char firmwareUpdated(char key, char first);
 volatile char firstSetup(char key, char first);
 volatile char timerRevert(char key, char first);
@@ -10,6 +51,8 @@ volatile char timerSaveDefault(char key, char first);
 volatile char timerStatus(char key, char first);
 volatile char timerStatusRemote(char key, char first);
 void displayTimerStatus(uint8_t remote_system);
+void displayTimingStats(void);
+void displayEnergy(void);
 volatile char timerRemoteStart(char key, char first);
 volatile char menuBack(char key, char first);
 volatile char factoryReset(char key, char first);
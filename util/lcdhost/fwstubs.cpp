@@ -0,0 +1,349 @@
+/*
+ *  fwstubs.cpp
+ *  Timelapse+
+ *
+ *  The rest of the firmware tlp_menu_functions.cpp links against, so
+ *  lcdemu can run the real status and bulb ramp screens.  The objects
+ *  are ordinary globals the script fills in (timer.status, camera,
+ *  light, ...); the calls that would drive hardware do nothing.  The
+ *  exposure names come from the real PTP lists.
+ *
+ */
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+#include "tldefs.h"
+#include "clock.h"
+#include "button.h"
+#include "hardware.h"
+#include "settings.h"
+#include "shutter.h"
+#include "IR.h"
+#include "bluetooth.h"
+#include "PTP_Driver.h"
+#include "PTP.h"
+#include "PTP_Lists.h"
+#include "remote.h"
+#include "light.h"
+#include "nmx.h"
+#include "energy.h"
+#include "notify.h"
+#include "math.h"
+#include "stubs.h"
+
+shutter timer;
+PTP camera;
+Light light;
+Remote remote;
+BT bt;
+IR ir;
+Energy energy;
+Notify notify;
+
+uint8_t battery_percent;
+volatile uint8_t connectUSBcamera;
+uint8_t settings_reset;
+uint8_t lastShutterError;
+program stored[MAX_STORED+1]EEMEM;
+keyframeGroup_t kfg;
+
+char PTP_CameraModel[23];
+volatile uint8_t PTP_Ready, PTP_Connected;
+volatile uint16_t PTP_Error, PTP_Response_Code;
+
+uint8_t host_iso, host_aperture;
+
+/******************************************************************
+ *
+ *   Clock, Button
+ *
+ ******************************************************************/
+
+uint32_t Clock::Seconds()
+{
+    return host_ms / 1000;
+}
+
+uint32_t Clock::eventMs()
+{
+    return host_ms;
+}
+
+void Clock::tare() {}
+void Clock::awake() {}
+
+char Button::pressed()
+{
+    return 0;
+}
+
+/******************************************************************
+ *
+ *   Hardware, settings
+ *
+ ******************************************************************/
+
+void hardware_off(void) {}
+void hardware_bootloader(void) {}
+void hardware_lightning_enable(void) {}
+void hardware_lightning_disable(void) {}
+
+int hardware_freeMemory(void)
+{
+    return 1024;
+}
+
+unsigned int hardware_readLight(uint8_t r)
+{
+    return 0;
+}
+
+char battery_status(void)
+{
+    return 0;
+}
+
+void settings_load(void) {}
+void settings_update(void) {}
+void settings_default(void) {}
+
+/******************************************************************
+ *
+ *   shutter
+ *
+ ******************************************************************/
+
+shutter::shutter()
+{
+}
+
+void shutter::begin(void) {}
+void shutter::pause(uint8_t p) {}
+void shutter::save(char id) {}
+void shutter::load(char id) {}
+void shutter::setDefault(void) {}
+int8_t shutter::nextId(void) { return 1; }
+void shutter::calculateExposure(uint32_t *nextBulbLength, uint8_t *nextAperture, uint8_t *nextISO, int8_t *bulbChangeEv) {}
+void shutter::off(void) {}
+void shutter::half(void) {}
+void shutter::full(void) {}
+void shutter::bulbEnd(void) {}
+void shutter::bulbStart(void) {}
+void shutter::capture(void) {}
+char shutter::cableIsConnected(void) { return 0; }
+void shutter::switchToGuided() {}
+void shutter::switchToAuto() {}
+
+void shutter_bulbEnd(void) {}
+void shutter_bulbStart(void) {}
+void shutter_capture(void) {}
+
+// the worst value stands in for the histogram's 99th percentile //
+uint32_t timingStatP99(timing_stat *s)
+{
+    return (uint32_t)(s->max > 0 - s->min ? s->max : 0 - s->min);
+}
+
+uint8_t stopName(char name[8], uint8_t stop)
+{
+    strcpy(name, "   0   ");
+    return 1;
+}
+
+uint8_t hdrExpsName(char name[8], uint8_t hdr_exps)
+{
+    strcpy(name, "      3");
+    return 1;
+}
+
+uint8_t stopUp(uint8_t stop) { return stop; }
+uint8_t stopDown(uint8_t stop) { return stop; }
+uint8_t hdrTvUp(uint8_t ev) { return ev; }
+uint8_t hdrTvDown(uint8_t ev) { return ev; }
+uint8_t bracketUp(uint8_t ev) { return ev; }
+uint8_t bracketDown(uint8_t ev) { return ev; }
+uint8_t hdrExpsUp(uint8_t hdr_exps) { return hdr_exps; }
+uint8_t hdrExpsDown(uint8_t hdr_exps) { return hdr_exps; }
+uint8_t tvUp(uint8_t ev) { return ev; }
+uint8_t tvDown(uint8_t ev) { return ev; }
+uint8_t rampTvUp(uint8_t ev) { return ev; }
+uint8_t rampTvUpStatic(uint8_t ev) { return ev; }
+uint8_t rampTvUpExtended(uint8_t ev) { return ev; }
+uint8_t rampTvDown(uint8_t ev) { return ev; }
+uint8_t rampTvDownExtended(uint8_t ev) { return ev; }
+
+/******************************************************************
+ *
+ *   PTP
+ *
+ ******************************************************************/
+
+PTP::PTP(void)
+{
+}
+
+static uint8_t listName(char name[8], const propertyDescription_t *list, uint8_t count, uint8_t ev)
+{
+    for(uint8_t i = 0; i < count; i++)
+    {
+        if(list[i].ev == ev)
+        {
+            memcpy(name, list[i].name, 8);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint8_t PTP::isoName(char name[8], uint8_t ev)
+{
+    return listName(name, PTP_ISO_List, sizeof(PTP_ISO_List) / sizeof(PTP_ISO_List[0]), ev);
+}
+
+uint8_t PTP::apertureName(char name[8], uint8_t ev)
+{
+    return listName(name, PTP_Aperture_List, sizeof(PTP_Aperture_List) / sizeof(PTP_Aperture_List[0]), ev);
+}
+
+uint8_t PTP::shutterName(char name[8], uint8_t ev)
+{
+    return listName(name, PTP_Shutter_List, sizeof(PTP_Shutter_List) / sizeof(PTP_Shutter_List[0]), ev);
+}
+
+// bulb lengths only, as long as a ramp runs //
+uint8_t PTP::bulbName(char name[8], uint32_t bulb_time)
+{
+    name[0] = '\0';
+    if(bulb_time == 0) return 0;
+    for(uint8_t i = 1; i < sizeof(Bulb_List) / sizeof(Bulb_List[0]); i++)
+    {
+        if(Bulb_List[i].ms >= bulb_time)
+        {
+            memcpy(name, Bulb_List[i].name, 8);
+            return 2;
+        }
+    }
+    return 0;
+}
+
+uint8_t PTP::bulbMin(void) { return Bulb_List[1].ev; }
+uint8_t PTP::bulbMinStatic(void) { return Bulb_List[1].ev; }
+uint32_t PTP::bulbTime(int8_t ev) { return 0; }
+uint32_t PTP::bulbTime(float ev) { return 0; }
+uint8_t PTP::isInBulbMode(void) { return 1; }
+
+uint8_t PTP::iso(void) { return host_iso; }
+uint8_t PTP::shutter(void) { return 0; }
+uint8_t PTP::aperture(void) { return host_aperture; }
+
+uint8_t PTP::isoUp(uint8_t ev) { return ev; }
+uint8_t PTP::isoDown(uint8_t ev) { return ev; }
+uint8_t PTP::isoUpStatic(uint8_t ev) { return ev; }
+uint8_t PTP::isoDownStatic(uint8_t ev) { return ev; }
+uint8_t PTP::apertureUp(uint8_t ev) { return ev; }
+uint8_t PTP::apertureDown(uint8_t ev) { return ev; }
+uint8_t PTP::apertureUpStatic(uint8_t ev) { return ev; }
+uint8_t PTP::apertureDownStatic(uint8_t ev) { return ev; }
+uint8_t PTP::bulbDown(uint8_t ev) { return ev; }
+
+uint8_t PTP::checkEvent(void) { return 0; }
+void PTP::resetConnection(void) {}
+uint8_t PTP::capture(void) { return 0; }
+uint8_t PTP::liveView(uint8_t on) { return 0; }
+uint8_t PTP::moveFocus(int8_t move, uint16_t steps) { return 0; }
+uint8_t PTP::videoStart(void) { return 0; }
+uint8_t PTP::videoStop(void) { return 0; }
+uint8_t PTP::setFocus(uint8_t af) { return 0; }
+uint8_t PTP::setISO(uint8_t value) { return 0; }
+uint8_t PTP::writeFile(char *name, uint8_t *data, uint16_t dataSize) { return 0; }
+
+/******************************************************************
+ *
+ *   Light, Remote, BT, IR, NMX, Energy, Notify
+ *
+ ******************************************************************/
+
+Light::Light()
+{
+}
+
+void Light::start() {}
+void Light::stop() {}
+void Light::integrationStart(uint8_t integration_minutes) {}
+float Light::readEv() { return 0.0; }
+float Light::readIntegratedSlope() { return 0.0; }
+
+Remote::Remote(void)
+{
+}
+
+uint8_t Remote::request(uint8_t id) { return 0; }
+uint8_t Remote::set(uint8_t id) { return 0; }
+uint8_t Remote::set(uint8_t id, uint8_t value) { return 0; }
+uint8_t Remote::watch(uint8_t id) { return 0; }
+uint8_t Remote::unWatch(uint8_t id) { return 0; }
+uint8_t Remote::send(uint8_t id, uint8_t type) { return 0; }
+
+BT::BT(void)
+{
+}
+
+uint8_t BT::sleep(void) { return 0; }
+uint8_t BT::version(void) { return 0; }
+uint8_t BT::scan(void) { return 0; }
+uint8_t BT::advertise(void) { return 0; }
+uint8_t BT::connect(char *address) { return 0; }
+uint8_t BT::disconnect(void) { return 0; }
+
+IR::IR()
+{
+}
+
+void IR::shutterNow() {}
+void IR::shutterDelayed() {}
+
+NMX::NMX(uint8_t node, uint8_t motor) {}
+uint8_t NMX::enable() { return 0; }
+uint8_t NMX::moveForward() { return 0; }
+uint8_t NMX::moveBackward() { return 0; }
+uint8_t NMX::moveToPosition(int32_t pos) { return 0; }
+
+Energy::Energy()
+{
+}
+
+float Energy::mAh(uint8_t consumer)
+{
+    return 0.0;
+}
+
+Notify::Notify(void)
+{
+}
+
+void Notify::changed(uint8_t item) {}
+
+/******************************************************************
+ *
+ *   Menu helpers from other files
+ *
+ ******************************************************************/
+
+void lightTest() {}
+
+float curve(float p0, float p1, float p2, float p3, float t)
+{
+    return p1 + (p2 - p1) * t;
+}
+
+uint16_t arrayMedian50UInt(const uint16_t *array, const uint8_t length)
+{
+    return length ? array[length / 2] : 0;
+}
+
+int16_t arrayMedian50Int(const int16_t *array, const uint8_t length)
+{
+    return length ? array[length / 2] : 0;
+}
@@ -0,0 +1,100 @@
+/*
+ *  lcdbench.cpp
+ *  Timelapse+
+ *
+ *  Times a full menu redraw into the LCD buffer with text drawn a
+ *  pixel at a time (lcd.pixelText, the old way) and with the glyph
+ *  column blitter, and checks both give the same frame.
+ *
+ *  Usage:
+ *
+ *  make && ./lcdbench [frames]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "5110LCD.h"
+
+LCD lcd;
+
+static const char *rows[] = {
+    "Time-lapse  >", "Bulb Ramp   >", "Trigger     >", "Connect     >",
+    "Light Meter >", "Settings    >", "System Info >", "Cable Remote" };
+
+/******************************************************************
+ *
+ *   drawMenu
+ *   Roughly what MENU::init draws: title, rows at a 9 pixel pitch
+ *   less the scroll offset, and the bottom bar
+ *
+ ******************************************************************/
+
+static void drawMenu(uint8_t scroll)
+{
+    lcd.cls();
+    lcd.writeStringTiny(29, 0, "MAIN MENU");
+
+    for(uint8_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++)
+    {
+        lcd.writeString(8, 8 + 9 * i - scroll, (char *)rows[i]);
+    }
+
+    lcd.writeStringTiny(2, 42, "BACK");
+    lcd.writeStringTiny(60, 42, "12:05 +1/3");
+}
+
+/******************************************************************
+ *
+ *   timeFrames
+ *   Microseconds per redraw, scrolling through every offset
+ *
+ ******************************************************************/
+
+static double timeFrames(uint8_t pixelText, long frames)
+{
+    lcd.pixelText = pixelText;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long n = 0; n < frames; n++)
+    {
+        drawMenu((uint8_t)(n % 40));
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / (double)frames;
+}
+
+int main(int argc, char **argv)
+{
+    long frames = argc > 1 ? atol(argv[1]) : 20000;
+    unsigned char ref[LCD_WIDTH][LCD_HEIGHT >> 3];
+
+    // same pixels both ways, including rows partly above the top //
+    for(int scroll = 0; scroll < 256; scroll++)
+    {
+        lcd.pixelText = 1;
+        drawMenu((uint8_t)scroll);
+        memcpy(ref, lcd.screen, sizeof(ref));
+
+        lcd.pixelText = 0;
+        drawMenu((uint8_t)scroll);
+        if(memcmp(ref, lcd.screen, sizeof(ref)) != 0)
+        {
+            printf("frames differ at scroll %d\n", scroll);
+            return 1;
+        }
+    }
+
+    double pixel = timeFrames(1, frames);
+    double blit = timeFrames(0, frames);
+
+    printf("menu redraw, %ld frames\n", frames);
+    printf("  pixel at a time: %8.2f us/frame\n", pixel);
+    printf("  glyph columns:   %8.2f us/frame\n", blit);
+    printf("  speedup:         %8.2fx\n", pixel / blit);
+
+    return 0;
+}
@@ -0,0 +1,447 @@
+/*
+ *  lcdemu.cpp
+ *  Timelapse+
+ *
+ *  Runs the menu code (src/Menu.cpp), the screens in
+ *  src/tlp_menu_functions.cpp and the LCD driver on a PC with the panel
+ *  emulated behind SPDR (pcd8544.cpp), walks a script of screens and,
+ *  for each one, saves or compares what the panel shows and reports
+ *  what it cost to get there.  The timer, camera and light state the
+ *  status and bulb ramp screens show is set by the script, see
+ *  fwstubs.cpp.
+ *
+ *  Every step also checks the emulated panel against LCD::screen, so
+ *  a span the dirty tracking or the SPI interrupt missed shows up as
+ *  "panel differs".
+ *
+ *  Usage:
+ *
+ *  make && ./lcdemu [-w dir] [-c dir] [-n redraws]
+ *
+ *  -w dir   write each screen as dir/<name>.pbm
+ *  -c dir   compare each screen with dir/<name>.pbm, exit 1 if any differ
+ *  -n       redraws timed per screen (default 2000)
+ *
+ *  The frames in golden/ are from a known good build; "make check"
+ *  compares against them.  After a change that is meant to move
+ *  pixels, look at the new frames and rewrite them with -w golden.
+ *  "convert x.pbm -scale 400% x.png" makes them easier to look at.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <avr/eeprom.h>
+#include "tldefs.h"
+#include "5110LCD.h"
+#include "button.h"
+#include "Menu.h"
+#include "settings.h"
+#include "shutter.h"
+#include "PTP_Driver.h"
+#include "PTP.h"
+#include "light.h"
+#include "tlp_menu_functions.h"
+#include "pcd8544.h"
+#include "stubs.h"
+
+#define SPI_US_PER_BYTE 2 // fosc/2 at 8MHz
+#define COND_DEMO_RAMP 0
+
+extern settings_t conf;
+extern shutter timer;
+extern PTP camera;
+extern Light light;
+extern uint8_t battery_percent;
+
+LCD lcd;
+MENU menu;
+Button button;
+
+/******************************************************************
+ *
+ *   Demo menus, shaped like the ones in Menu_Map.h but fixed, so
+ *   their frames only move when Menu.cpp or the LCD driver does
+ *
+ ******************************************************************/
+
+static const char STR_TIME[] = "h:mm:ss";
+static const char STR_PHOTOS[] = "0 for inf.";
+static const char STR_TIME_TENTHS[] = "mm:ss.s";
+static const char STR_RETURN[] = "RETURN";
+static const char STR_NULL[] = "";
+
+static unsigned int mode = 1, delay = 90, frames = 300, gap = 50, rampStops = 0;
+
+static const settings_item settings_mode[] =
+{
+    { "Time-lapse  ", 0, 0 },
+    { "Bulb-ramp   ", 1, 0 },
+    { "\0           ", 0, 0 }
+};
+
+static const menu_item menu_demo_timelapse[] =
+{
+    { "Mode       *", 'S', (void*)settings_mode, (void*)&mode, 0, 0 },
+    { "Ramp Stops U", 'E', (void*)&rampStops, (void*)STR_NULL, 0, MENU_CONDITION(COND_DEMO_RAMP) },
+    { "Delay      T", 'E', (void*)&delay, (void*)STR_TIME, 0, 0 },
+    { "Frames     U", 'E', (void*)&frames, (void*)STR_PHOTOS, 0, 0 },
+    { "Intrvl     F", 'E', (void*)&gap, (void*)STR_TIME_TENTHS, 0, 0 },
+    { "\0           ", 'B', 0, (void*)STR_RETURN, 0, (void*)STR_NULL }
+};
+
+static const menu_item menu_demo_main[] =
+{
+    { "Timelapse   ", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "Trigger     ", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "Connect     ", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "Light Meter ", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "Settings    ", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "System Info ", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "Cable Remote", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "Power Off   ", 'M', (void*)menu_demo_timelapse, 0, 0, 0 },
+    { "\0           ", 'V', 0, 0, 0, 0 }
+};
+
+/******************************************************************
+ *
+ *   flush
+ *   Lets the SPI interrupt send everything swapped so far
+ *
+ ******************************************************************/
+
+static void flush()
+{
+    do
+    {
+        lcd.task();
+        spi_run();
+    } while(lcd.busy());
+}
+
+/******************************************************************
+ *
+ *   panelMatches
+ *   True if the emulated panel RAM holds LCD::screen
+ *
+ ******************************************************************/
+
+static uint8_t panelMatches()
+{
+    return memcmp(panel.ram, lcd.screen, sizeof(panel.ram)) == 0;
+}
+
+/******************************************************************
+ *
+ *   step
+ *   One pass of the UI task with a key, 20ms apart
+ *
+ ******************************************************************/
+
+static void step(char key)
+{
+    host_key = key;
+    menu.task();
+    flush();
+    host_ms += 20;
+}
+
+/******************************************************************
+ *
+ *   Script
+ *
+ ******************************************************************/
+
+struct screen_t
+{
+    const char *name;
+    void (*reach)(void);   // from the screen before
+    void (*redraw)(void);  // timed
+};
+
+static void menuRedraw()
+{
+    menu.refresh();
+    step(0);
+    step(0);
+}
+
+static void reachMain()
+{
+    menu.init((menu_item*)menu_demo_main);
+    lcd.update();
+    flush();
+}
+
+static void reachScrolled()
+{
+    for(uint8_t i = 0; i < 6; i++) step(DOWN_KEY);
+    step(0);
+}
+
+static void reachTimelapse()
+{
+    for(uint8_t i = 0; i < 6; i++) step(UP_KEY);
+    step(RIGHT_KEY);
+    step(0);
+}
+
+static void reachRamp()
+{
+    menu.setCondition(COND_DEMO_RAMP, 1);
+    step(0);
+    step(0);
+}
+
+static void reachEdit()
+{
+    step(DOWN_KEY);
+    step(DOWN_KEY);
+    step(RIGHT_KEY);
+    step(0);
+}
+
+static void reachMessage()
+{
+    step(LEFT_KEY);
+    step(0);
+    menu.message(TEXT("Saved"));
+    step(0);
+}
+
+// a pass with the clock held, so pop-ups stay up and the bulb ramp screen doesn't dim //
+static void heldRedraw()
+{
+    menu.task();
+    flush();
+}
+
+static void reachStatus()
+{
+    host_ms += MENU_MESSAGE_DISPLAY_TIME;
+    step(0);
+
+    timer.running = 1;
+    timer.status.mode = TIMELAPSE;
+    timer.status.photosTaken = 42;
+    timer.status.photosRemaining = 258;
+    timer.status.nextPhoto = 7;
+    strcpy(timer.status.textStatus, "Waiting");
+    battery_percent = 87;
+
+    menu.spawn((void*)timerStatus);
+    step(0);
+    step(0);
+}
+
+static void reachTiming()
+{
+    timer.timing.start.mean = 3;
+    timer.timing.start.max = 41;
+    timer.timing.start.count = 42;
+    timer.timing.bulb.mean = -1;
+    timer.timing.bulb.min = -12;
+    timer.timing.bulb.count = 42;
+    timer.timing.dead.mean = 1850;
+    timer.timing.dead.max = 2300;
+    timer.timing.dead.count = 41;
+
+    step(UP_KEY);
+    step(0);
+}
+
+static void reachBrampDim()
+{
+    menu.setCondition(COND_MODE_RAMP, 1);
+    conf.brampMode = BRAMP_MODE_ALL;
+    camera.supports.aperture = 1;
+    camera.supports.iso = 1;
+    host_aperture = 15; // f/5.6
+    host_iso = 37;      // 400
+
+    host_ms = 20 * 60 * 1000UL; // 20 minutes into an hour's ramp
+    timer.current.Mode = TIMELAPSE | RAMP;
+    timer.current.brampMethod = BRAMP_METHOD_GUIDED;
+    timer.current.Duration = 60;
+    timer.rampRate = 12;
+    timer.last_photo_ms = host_ms - 4000;
+    timer.status.photosTaken = 120;
+    timer.status.rampMin = 0;
+    timer.status.rampMax = 30;
+    timer.status.rampStops = 9;
+    timer.status.bulbLength = 2000;
+    timer.status.interval = 100;
+    strcpy(timer.status.textStatus, "Running");
+    light.paused = 1;
+
+    // RIGHT left the timing page; with nothing pressed since the start it dims at once //
+    step(RIGHT_KEY);
+    heldRedraw();
+}
+
+static void reachBramp()
+{
+    host_key = UP_KEY; // wakes it up, doesn't change the rate
+    heldRedraw();
+    heldRedraw(); // the bar follows a pass later
+}
+
+static void reachBrampPaused()
+{
+    timer.paused = 1;
+    heldRedraw();
+}
+
+static const screen_t screens[] =
+{
+    { "main", reachMain, menuRedraw },
+    { "main_scrolled", reachScrolled, menuRedraw },
+    { "timelapse", reachTimelapse, menuRedraw },
+    { "timelapse_ramp", reachRamp, menuRedraw },
+    { "edit_delay", reachEdit, menuRedraw },
+    { "message", reachMessage, heldRedraw },
+    { "status", reachStatus, heldRedraw },
+    { "timing", reachTiming, heldRedraw },
+    { "bramp_dim", reachBrampDim, heldRedraw },
+    { "bramp", reachBramp, heldRedraw },
+    { "bramp_paused", reachBrampPaused, heldRedraw },
+};
+
+/******************************************************************
+ *
+ *   compare
+ *   Pixels that differ from a saved P1 frame, -1 if it can't be read
+ *
+ ******************************************************************/
+
+static int compare(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if(!f) return -1;
+
+    int w, h, diff = 0;
+    if(fscanf(f, "P1 %d %d", &w, &h) != 2 || w != PCD8544_WIDTH || h != PCD8544_BANKS * 8)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    for(int y = 0; y < h; y++)
+    {
+        for(int x = 0; x < w; x++)
+        {
+            int c;
+            do c = fgetc(f); while(c == ' ' || c == '\n' || c == '\r');
+            if(c == EOF)
+            {
+                fclose(f);
+                return -1;
+            }
+            if((c == '1') != (panel.pixel(x, y) != 0)) diff++;
+        }
+    }
+
+    fclose(f);
+    return diff;
+}
+
+int main(int argc, char **argv)
+{
+    const char *writeDir = 0, *checkDir = 0;
+    long redraws = 2000;
+    int opt, failed = 0;
+
+    while((opt = getopt(argc, argv, "w:c:n:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'w': writeDir = optarg; break;
+            case 'c': checkDir = optarg; break;
+            case 'n': redraws = atol(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-w dir] [-c dir] [-n redraws]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    conf.menuWrap = 1;
+    menu.lcd = &lcd;
+    menu.button = &button;
+    lcd.init(0x30);
+    flush();
+
+    printf("%-16s %8s %8s %10s %10s  %s\n", "screen", "bytes", "spi ms", "redraw us", "redraw B", "");
+
+    for(uint8_t s = 0; s < sizeof(screens) / sizeof(screens[0]); s++)
+    {
+        const screen_t *sc = &screens[s];
+        char path[256], result[300] = "";
+
+        uint32_t before = panel.data + panel.commands;
+        sc->reach();
+        uint32_t bytes = panel.data + panel.commands - before;
+
+        if(!panelMatches())
+        {
+            snprintf(result, sizeof(result), "panel differs from LCD::screen");
+            failed = 1;
+        }
+
+        if(writeDir)
+        {
+            snprintf(path, sizeof(path), "%s/%s.pbm", writeDir, sc->name);
+            FILE *f = fopen(path, "w");
+            if(f)
+            {
+                panel.writePBM(f);
+                fclose(f);
+            }
+            else
+            {
+                perror(path);
+                failed = 1;
+            }
+        }
+
+        if(checkDir && !result[0])
+        {
+            snprintf(path, sizeof(path), "%s/%s.pbm", checkDir, sc->name);
+            int diff = compare(path);
+            if(diff < 0)
+            {
+                snprintf(result, sizeof(result), "can't read %s", path);
+                failed = 1;
+            }
+            else if(diff > 0)
+            {
+                snprintf(result, sizeof(result), "%d pixels differ", diff);
+                failed = 1;
+            }
+            else
+            {
+                snprintf(result, sizeof(result), "ok");
+            }
+        }
+
+        // the redraws leave the screen where it was //
+        before = panel.data + panel.commands;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long n = 0; n < redraws; n++) sc->redraw();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double us = redraws ? std::chrono::duration<double, std::micro>(end - start).count() / (double)redraws : 0;
+        double perRedraw = redraws ? (double)(panel.data + panel.commands - before) / (double)redraws : 0;
+
+        if(!panelMatches() && !result[0])
+        {
+            snprintf(result, sizeof(result), "panel differs after redraws");
+            failed = 1;
+        }
+
+        printf("%-16s %8u %8.2f %10.2f %10.1f  %s\n", sc->name, bytes, bytes * SPI_US_PER_BYTE / 1000.0, us, perRedraw, result);
+    }
+
+    return failed;
+}
@@ -0,0 +1,150 @@
+/*
+ *  pcd8544.cpp
+ *  Timelapse+
+ *
+ *  Emulated PCD8544, fed from SPDR (regs.cpp)
+ *
+ */
+
+#include <string.h>
+#include <avr/io.h>
+#include "pcd8544.h"
+
+extern "C" void SPI_STC_vect(void);
+
+PCD8544 panel;
+
+/******************************************************************
+ *
+ *   PCD8544::PCD8544
+ *
+ *
+ ******************************************************************/
+
+PCD8544::PCD8544()
+{
+    memset(ram, 0, sizeof(ram));
+    x = 0;
+    bank = 0;
+    extended = 0;
+    vertical = 0;
+    powerDown = 1;
+    mode = 0;
+    vop = 0;
+    commands = 0;
+    data = 0;
+}
+
+/******************************************************************
+ *
+ *   PCD8544::clock
+ *   Takes one byte from the bus, D/C high for display data
+ *
+ ******************************************************************/
+
+void PCD8544::clock(uint8_t b, uint8_t isData)
+{
+    if(isData)
+    {
+        data++;
+        ram[x][bank] = b;
+
+        if(vertical)
+        {
+            if(++bank >= PCD8544_BANKS)
+            {
+                bank = 0;
+                if(++x >= PCD8544_WIDTH) x = 0;
+            }
+        }
+        else
+        {
+            if(++x >= PCD8544_WIDTH)
+            {
+                x = 0;
+                if(++bank >= PCD8544_BANKS) bank = 0;
+            }
+        }
+        return;
+    }
+
+    commands++;
+
+    if((b & 0xF8) == 0x20) // function set, either instruction set
+    {
+        powerDown = (b >> 2) & 1;
+        vertical = (b >> 1) & 1;
+        extended = b & 1;
+    }
+    else if(extended)
+    {
+        if(b & 0x80) vop = b & 0x7F;
+        // temperature coefficient and bias don't change the picture
+    }
+    else if(b & 0x80)
+    {
+        x = b & 0x7F;
+        if(x >= PCD8544_WIDTH) x = 0;
+    }
+    else if(b & 0x40)
+    {
+        bank = b & 0x07;
+        if(bank >= PCD8544_BANKS) bank = 0;
+    }
+    else if((b & 0xF8) == 0x08) // display control
+    {
+        mode = ((b >> 1) & 2) | (b & 1);
+    }
+}
+
+/******************************************************************
+ *
+ *   PCD8544::pixel
+ *   What the glass shows at x, y, after the display mode
+ *
+ ******************************************************************/
+
+uint8_t PCD8544::pixel(uint8_t px, uint8_t py)
+{
+    if(powerDown || mode == 0) return 0;
+    if(mode == 1) return 1;
+
+    uint8_t on = (ram[px][py >> 3] >> (py & 7)) & 1;
+
+    return mode == 3 ? !on : on;
+}
+
+/******************************************************************
+ *
+ *   PCD8544::writePBM
+ *   Plain PBM, one row of pixels per line so frames diff as text
+ *
+ ******************************************************************/
+
+void PCD8544::writePBM(FILE *f)
+{
+    fprintf(f, "P1\n%d %d\n", PCD8544_WIDTH, PCD8544_BANKS * 8);
+
+    for(uint8_t py = 0; py < PCD8544_BANKS * 8; py++)
+    {
+        for(uint8_t px = 0; px < PCD8544_WIDTH; px++) fputc(pixel(px, py) ? '1' : '0', f);
+        fputc('\n', f);
+    }
+}
+
+/******************************************************************
+ *
+ *   spi_run
+ *   Runs the SPI interrupt for as long as it keeps the bus going,
+ *   standing in for the transfers the AVR does in the background
+ *
+ ******************************************************************/
+
+void spi_run(void)
+{
+    while((SPCR & _BV(SPIE)) && (SPSR & _BV(SPIF)))
+    {
+        SPSR &= ~_BV(SPIF);
+        SPI_STC_vect();
+    }
+}
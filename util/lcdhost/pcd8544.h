@@ -0,0 +1,45 @@
+/*
+ *  pcd8544.h
+ *  Timelapse+
+ *
+ *  The LCD controller, emulated from the bytes clocked out through
+ *  SPDR, so a host build sees what the panel would show rather than
+ *  what LCD::screen says it should
+ *
+ */
+
+#ifndef HOST_PCD8544_H
+#define HOST_PCD8544_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define PCD8544_WIDTH 84
+#define PCD8544_BANKS 6
+
+class PCD8544
+{
+public:
+
+    PCD8544();
+    void clock(uint8_t b, uint8_t data);
+    uint8_t pixel(uint8_t x, uint8_t y);
+    void writePBM(FILE *f);
+
+    uint8_t ram[PCD8544_WIDTH][PCD8544_BANKS];
+    uint8_t x, bank;
+    uint8_t extended;     // H bit of function set
+    uint8_t vertical;     // V bit of function set
+    uint8_t powerDown;
+    uint8_t mode;         // display control D,E: 0 blank, 1 all on, 2 normal, 3 inverse
+    uint8_t vop;
+
+    uint32_t commands;
+    uint32_t data;
+};
+
+extern PCD8544 panel;
+
+void spi_run(void);
+
+#endif
@@ -0,0 +1,35 @@
+/*
+ *  regs.cpp
+ *  Timelapse+
+ *
+ *  Registers behind shim/avr/io.h
+ *
+ */
+
+#include <avr/io.h>
+#include "hardware.h"
+#include "pcd8544.h"
+
+volatile uint8_t PORTA, DDRA, PINA;
+volatile uint8_t PORTB, DDRB, PINB;
+volatile uint8_t PORTC, DDRC, PINC;
+volatile uint8_t PORTE, DDRE, PINE;
+volatile uint8_t PORTF, DDRF, PINF;
+volatile uint8_t SPCR, SPSR, SREG;
+volatile spi_data_t SPDR;
+volatile uint16_t TCNT3;
+
+static uint8_t spiLast;
+
+uint8_t spi_data_t::operator=(uint8_t b) volatile
+{
+    if(!isHigh(SPI_CS)) panel.clock(b, isHigh(LCD_DC));
+    spiLast = b;
+    SPSR |= _BV(SPIF);
+    return b;
+}
+
+spi_data_t::operator uint8_t() const volatile
+{
+    return spiLast; // the panel never answers
+}
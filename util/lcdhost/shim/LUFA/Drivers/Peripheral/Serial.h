@@ -0,0 +1,12 @@
+/*
+ *  LUFA/Drivers/Peripheral/Serial.h (host)
+ *  Timelapse+
+ *
+ *  Only included, see LUFA/Drivers/USB/USB.h
+ *
+ */
+
+#ifndef HOST_LUFA_SERIAL_H
+#define HOST_LUFA_SERIAL_H
+
+#endif
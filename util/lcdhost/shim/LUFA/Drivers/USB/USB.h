@@ -0,0 +1,28 @@
+/*
+ *  LUFA/Drivers/USB/USB.h (host)
+ *  Timelapse+
+ *
+ *  Stand-ins for the LUFA types the firmware headers name, so
+ *  tlp_menu_functions.cpp builds for lcdemu.  Nothing USB runs on
+ *  the host; the layouts don't matter.
+ *
+ */
+
+#ifndef HOST_LUFA_USB_H
+#define HOST_LUFA_USB_H
+
+#include <stdint.h>
+
+#define ATTR_WARN_UNUSED_RESULT
+#define ATTR_NON_NULL_PTR_ARG(...)
+
+typedef struct { uint8_t b; } USB_Descriptor_Configuration_Header_t;
+typedef struct { uint8_t b; } USB_Descriptor_Interface_t;
+typedef struct { uint8_t b; } USB_Descriptor_Endpoint_t;
+typedef struct { uint8_t b; } USB_CDC_Descriptor_FunctionalHeader_t;
+typedef struct { uint8_t b; } USB_CDC_Descriptor_FunctionalACM_t;
+typedef struct { uint8_t b; } USB_CDC_Descriptor_FunctionalUnion_t;
+typedef struct { uint8_t b; } USB_ClassInfo_SI_Host_t;
+typedef struct { uint8_t b; } PIMA_Container_t;
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ *  LUFA/Version.h (host)
+ *  Timelapse+
+ *
+ *  Only included, see LUFA/Drivers/USB/USB.h
+ *
+ */
+
+#ifndef HOST_LUFA_VERSION_H
+#define HOST_LUFA_VERSION_H
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ *  avr/eeprom.h (host)
+ *  Timelapse+
+ *
+ *  EEPROM is a block of RAM, see regs.cpp
+ *
+ */
+
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define EEMEM
+
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_write_block(const void *src, void *dst, size_t n);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+uint8_t eeprom_read_byte(const uint8_t *p);
+void eeprom_write_byte(uint8_t *p, uint8_t b);
+
+#endif
@@ -0,0 +1,14 @@
+/*
+ *  avr/interrupt.h (host)
+ *  Timelapse+
+ *
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#define ISR(vector) extern "C" void vector(void)
+#define cli()
+#define sei()
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ *  avr/io.h (host)
+ *  Timelapse+
+ *
+ *  Just enough of the AVR registers to build the LCD driver on a PC,
+ *  see util/lcdhost.  Writing SPDR clocks the byte into the emulated
+ *  panel (pcd8544.cpp) and sets SPIF, as the SPI hardware would.
+ *
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#define _BV(b) (1 << (b))
+
+extern volatile uint8_t PORTA, DDRA, PINA;
+extern volatile uint8_t PORTB, DDRB, PINB;
+extern volatile uint8_t PORTC, DDRC, PINC;
+extern volatile uint8_t PORTE, DDRE, PINE;
+extern volatile uint8_t PORTF, DDRF, PINF;
+struct spi_data_t
+{
+    uint8_t operator=(uint8_t b) volatile;
+    operator uint8_t() const volatile;
+};
+
+extern volatile uint8_t SPCR, SPSR, SREG;
+extern volatile spi_data_t SPDR;
+extern volatile uint16_t TCNT3;
+
+#define SPIE 7
+#define SPE 6
+#define MSTR 4
+#define SPIF 7
+#define SPI2X 0
+#define SREG_I 7
+
+#endif
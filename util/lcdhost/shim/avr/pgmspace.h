@@ -0,0 +1,28 @@
+/*
+ *  avr/pgmspace.h (host)
+ *  Timelapse+
+ *
+ *  Flash and RAM are the same thing on a PC
+ *
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <string.h>
+#include <stdint.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const unsigned char *)(p))
+// only used on pointer fields (menu tables), which are wider than a word here //
+static inline uintptr_t pgm_read_word(const void *p)
+{
+    uintptr_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+#define strcpy_P strcpy
+#define strlen_P strlen
+
+#endif
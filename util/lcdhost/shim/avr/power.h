@@ -0,0 +1,12 @@
+/*
+ *  avr/power.h (host)
+ *  Timelapse+
+ *
+ *  Only included, nothing in the host build sleeps.
+ *
+ */
+
+#ifndef HOST_AVR_POWER_H
+#define HOST_AVR_POWER_H
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ *  avr/sleep.h (host)
+ *  Timelapse+
+ *
+ *  Only included, nothing in the host build sleeps.
+ *
+ */
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ *  avr/wdt.h (host)
+ *  Timelapse+
+ *  No watchdog on the host.
+ *
+ */
+
+#ifndef HOST_AVR_WDT_H
+#define HOST_AVR_WDT_H
+
+#define wdt_reset()
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ *  util/delay.h (host)
+ *  Timelapse+
+ *
+ */
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#define _delay_us(us)
+#define _delay_ms(ms)
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ *  stubs.cpp
+ *  Timelapse+
+ *
+ *  The few firmware pieces Menu.cpp links against, enough to drive
+ *  the menus from a script on a PC.  EEMEM variables are ordinary
+ *  RAM here, so the EEPROM calls just copy.
+ *
+ */
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include "tldefs.h"
+#include "clock.h"
+#include "button.h"
+#include "settings.h"
+#include "hardware.h"
+#include "stubs.h"
+
+Clock clock;
+settings_t conf;
+
+uint32_t host_ms;
+char host_key;
+
+Clock::Clock()
+{
+}
+
+uint32_t Clock::Ms()
+{
+    return host_ms;
+}
+
+Button::Button()
+{
+}
+
+char Button::get()
+{
+    char key = host_key;
+    host_key = 0;
+    return key;
+}
+
+char hardware_flashlight(char on)
+{
+    return on;
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+uint8_t eeprom_read_byte(const uint8_t *p)
+{
+    return *p;
+}
+
+void eeprom_write_byte(uint8_t *p, uint8_t b)
+{
+    *p = b;
+}
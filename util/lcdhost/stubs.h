@@ -0,0 +1,16 @@
+/*
+ *  stubs.h
+ *  Timelapse+
+ *
+ */
+
+#ifndef HOST_STUBS_H
+#define HOST_STUBS_H
+
+#include <stdint.h>
+
+extern uint32_t host_ms;   // what Clock::Ms returns
+extern char host_key;      // the next key Button::get returns, then 0
+extern uint8_t host_iso, host_aperture; // what PTP::iso() and PTP::aperture() return (ev)
+
+#endif
@@ -0,0 +1,234 @@
+# mirror.rb
+# Shows the Timelapse+ screen live in the terminal
+#
+# Usage:
+#
+# ruby ./mirror.rb [capture]
+#
+# Sends 'W' to start the screen mirror; the device then pushes the
+# spans changed since its last frame, run-length coded (see
+# LCD::mirrorFill).  Prints frames per second, bytes per frame, lost
+# frames (gaps in the sequence number) and bad checksums under the
+# screen.  A lost or bad frame asks for a new key frame.  Ctrl-C sends
+# 'w' to stop it.
+#
+# Given a file instead (e.g. from "cat /dev/ttyACM0 > capture" after
+# sending 'W'), plays that back and prints the stats once.
+#
+# Looks for /dev/tty.usb* (Mac OS X) and /dev/ttyACM* (Linux cdc_acm)
+
+
+
+WIDTH = 84
+BANKS = 6
+SYNC = [0xA5, 0x5A]
+KEY = 0x01
+RUN = 0x80
+
+class Mirror
+	attr_reader :frames, :bytes, :lost, :bad, :screen
+
+	def initialize
+		@screen = Array.new(WIDTH * BANKS, 0)
+		@buf = []
+		@seq = nil
+		@synced = false
+		@frames = 0
+		@bytes = 0
+		@lost = 0
+		@bad = 0
+		@resync = false
+	end
+
+	# true once after a lost or bad frame, to ask for a key frame
+	def resync?
+		r = @resync
+		@resync = false
+		return r
+	end
+
+	def feed(data)
+		@buf.concat(data.bytes)
+		changed = false
+		until((n = frame).nil?)
+			changed = true if n
+		end
+		return changed
+	end
+
+	private
+
+	# Decodes one frame from the front of @buf; nil if more data is needed
+	def frame
+		i = 0
+		i += 1 while(i + 1 < @buf.length && (@buf[i] != SYNC[0] || @buf[i + 1] != SYNC[1]))
+		@buf.shift(i)
+		return nil if @buf.length < 6
+
+		flags = @buf[2]
+		seq = @buf[3] | (@buf[4] << 8)
+		spans = @buf[5]
+		pos = 6
+		sum = flags + @buf[3] + @buf[4] + spans
+		updates = []
+
+		spans.times do
+			return nil if pos + 3 > @buf.length
+			bank, x, len = @buf[pos, 3]
+			sum += bank + x + len
+			pos += 3
+			data = []
+			while(data.length < len)
+				return nil if pos >= @buf.length
+				t = @buf[pos]
+				sum += t
+				pos += 1
+				if(t & RUN != 0)
+					return nil if pos >= @buf.length
+					data.concat([@buf[pos]] * ((t & ~RUN) + 1))
+					sum += @buf[pos]
+					pos += 1
+				else
+					n = t + 1
+					return nil if pos + n > @buf.length
+					data.concat(@buf[pos, n])
+					n.times { |k| sum += @buf[pos + k] }
+					pos += n
+				end
+			end
+			updates.push([bank, x, data])
+		end
+		return nil if pos >= @buf.length
+
+		if((sum & 0xFF) != @buf[pos] || updates.any? { |u| u[0] >= BANKS || u[1] + u[2].length > WIDTH })
+			# not a frame after all (or damaged); skip the sync and look again
+			@bad += 1
+			@resync = true
+			@buf.shift(2)
+			return false
+		end
+		@buf.shift(pos + 1)
+
+		@synced = true if(flags & KEY != 0)
+		if(@seq && seq != ((@seq + 1) & 0xFFFF))
+			@lost += (seq - @seq - 1) & 0xFFFF
+			@synced = false if(flags & KEY == 0)
+			@resync = true
+		end
+		@seq = seq
+		@frames += 1
+		@bytes += pos + 1
+
+		if(@synced)
+			updates.each do |bank, x, data|
+				data.each_with_index { |b, k| @screen[(bank * WIDTH) + x + k] = b }
+			end
+		end
+		return true
+	end
+end
+
+# Two pixel rows per character cell
+def draw(screen)
+	out = "\e[H"
+	(BANKS * 4).times do |row|
+		line = ""
+		WIDTH.times do |x|
+			y = row * 2
+			top = screen[(y >> 3) * WIDTH + x][y & 7] == 1
+			bottom = screen[((y + 1) >> 3) * WIDTH + x][(y + 1) & 7] == 1
+			line += top ? (bottom ? "█" : "▀") : (bottom ? "▄" : " ")
+		end
+		out += line + "\n"
+	end
+	print out
+end
+
+def stats(m, seconds)
+	fps = seconds > 0 ? m.frames / seconds : 0
+	avg = m.frames > 0 ? m.bytes / m.frames : 0
+	"%6.1f fps  %5d bytes/frame  %7.1f kB/s  %d lost  %d bad" % [fps, avg, m.bytes / 1024.0 / [seconds, 0.001].max, m.lost, m.bad]
+end
+
+class TLP
+	def open(port)
+		port_str = port
+		baud_rate = 9600
+		data_bits = 8
+		stop_bits = 1
+		parity = SerialPort::NONE
+		@sp = SerialPort.new(port_str, baud_rate, data_bits, stop_bits, parity)
+		@sp.read_timeout=1000
+	end
+
+	def id
+		@sp.putc('T')
+		@sp.getc
+	end
+
+	def start
+		@sp.putc('W')
+	end
+
+	def stop
+		@sp.putc('w')
+	end
+
+	def read
+		@sp.read_timeout = 100
+		@sp.read(4096).to_s
+	end
+
+	def close
+		@sp.close if(@sp)
+	end
+
+	def find
+		result = false
+		list = `ls /dev/tty.usb* /dev/ttyACM* 2>/dev/null`
+		list.split("\n").each do |dev|
+			dev.strip!
+			begin
+				puts "Trying '" + dev + "'..."
+				open(dev)
+				result = true if id == "E"
+				break if result
+				close
+			rescue
+				puts "Error opening.\n"
+				close
+			end
+		end
+		return result
+	end
+end
+
+m = Mirror.new
+
+if(ARGV[0])
+	m.feed(File.binread(ARGV[0]))
+	draw(m.screen)
+	puts "%d frames, %d bytes, %d bytes/frame, %d lost, %d bad" % [m.frames, m.bytes, m.frames > 0 ? m.bytes / m.frames : 0, m.lost, m.bad]
+	exit
+end
+
+require 'serialport'
+
+device = TLP.new
+if(device.find)
+	print "\e[2J"
+	device.start
+	start = Time.now
+	begin
+		loop do
+			draw(m.screen) if m.feed(device.read)
+			device.start if m.resync?
+			print "\e[%d;1H" % (BANKS * 4 + 1) + stats(m, Time.now - start) + "\e[K"
+			$stdout.flush
+		end
+	rescue Interrupt
+		device.stop
+	end
+end
+
+device.close
@@ -0,0 +1,91 @@
+# ptpstats.rb
+# Prints the PTP transaction statistics from the Timelapse+
+#
+# Usage:
+#
+# ruby ./ptpstats.rb [reset]
+#
+# Lists count, errors, bytes in/out, max latency and the latency
+# histogram (ms) for each PTP opcode used since the camera was connected.
+# Pass "reset" to clear the counters after reading them.
+#
+# For Mac OS X only
+
+
+
+require 'serialport'
+
+SLOTS = 12
+BUCKETS = 10
+OTHER = 0xFFFF
+BUCKET_NAMES = ["0", "1", "2", "4", "8", "16", "32", "64", "128", "256+"]
+
+class TLP
+	def open(port)
+		port_str = port
+		baud_rate = 9600
+		data_bits = 8
+		stop_bits = 1
+		parity = SerialPort::NONE
+		@sp = SerialPort.new(port_str, baud_rate, data_bits, stop_bits, parity)
+		@sp.read_timeout=1000
+	end
+
+	def id
+		@sp.putc('T')
+		@sp.getc
+	end
+
+	# PTP_OpStats_t[SLOTS], packed little-endian
+	def stats
+		size = 2 + 2 + 2 + 4 + 4 + 2 + BUCKETS * 2
+		@sp.putc('o')
+		data = @sp.read(size * SLOTS)
+		list = Array.new()
+		SLOTS.times do |i|
+			f = data[i * size, size].unpack("vvvVVv" + "v" * BUCKETS)
+			next if f[0] == 0
+			list.push({ :op => f[0], :count => f[1], :errors => f[2], :in => f[3], :out => f[4], :max => f[5], :hist => f[6, BUCKETS] })
+		end
+		return list
+	end
+
+	def reset
+		@sp.putc('O')
+	end
+
+	def close
+		@sp.close if(@sp)
+	end
+
+	def find
+		result = false
+		list = `ls /dev/tty.usb*`
+		list.split("\n").each do |dev|
+			dev.strip!
+			begin
+				puts "Trying '" + dev + "'..."
+				open(dev)
+				result = true if id == "E"
+				break if result
+				close
+			rescue
+				puts "Error opening.\n"
+				close
+			end
+		end
+		return result
+	end
+end
+
+device = TLP.new
+if(device.find)
+	puts "opcode  count  errors   bytes in  bytes out  max ms  | " + BUCKET_NAMES.map { |b| b.rjust(5) }.join
+	device.stats.each do |s|
+		op = s[:op] == OTHER ? "other" : "0x%04X" % s[:op]
+		puts "%-6s %6d %7d %10d %10d %7d  | %s" % [op, s[:count], s[:errors], s[:in], s[:out], s[:max], s[:hist].map { |h| h.to_s.rjust(5) }.join]
+	end
+	device.reset if ARGV[0] == "reset"
+end
+
+device.close
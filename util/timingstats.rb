@@ -0,0 +1,104 @@
+# timingstats.rb
+# Prints the frame timing statistics from the Timelapse+
+#
+# Usage:
+#
+# ruby ./timingstats.rb [reset]
+#
+# Lists min, max, mean and p99 (ms) of how late each frame opened
+# versus its schedule, measured versus requested bulb length and the
+# dead time between frames, plus the log2 histogram for each.
+# Pass "reset" to clear the stats after reading them.
+#
+# For Mac OS X only
+
+
+
+require 'serialport'
+
+BUCKETS = 16
+NAMES = ["start", "bulb", "dead"]
+
+class TLP
+	def open(port)
+		port_str = port
+		baud_rate = 9600
+		data_bits = 8
+		stop_bits = 1
+		parity = SerialPort::NONE
+		@sp = SerialPort.new(port_str, baud_rate, data_bits, stop_bits, parity)
+		@sp.read_timeout=1000
+	end
+
+	def id
+		@sp.putc('T')
+		@sp.getc
+	end
+
+	# timing_stat[3], packed little-endian
+	def stats
+		size = 4 + 4 + 4 + 2 + BUCKETS * 2
+		@sp.putc('j')
+		data = @sp.read(size * NAMES.length)
+		list = Array.new()
+		NAMES.each_with_index do |name, i|
+			f = data[i * size, size].unpack("l<l<ev" + "v" * BUCKETS)
+			list.push({ :name => name, :min => f[0], :max => f[1], :mean => f[2], :count => f[3], :hist => f[4, BUCKETS] })
+		end
+		return list
+	end
+
+	def reset
+		@sp.putc('J')
+	end
+
+	def close
+		@sp.close if(@sp)
+	end
+
+	def find
+		result = false
+		list = `ls /dev/tty.usb*`
+		list.split("\n").each do |dev|
+			dev.strip!
+			begin
+				puts "Trying '" + dev + "'..."
+				open(dev)
+				result = true if id == "E"
+				break if result
+				close
+			rescue
+				puts "Error opening.\n"
+				close
+			end
+		end
+		return result
+	end
+end
+
+# Same bound the firmware shows: top of the bucket holding the 99th percentile
+def p99(s)
+	total = s[:hist].inject(0) { |a, h| a + h }
+	worst = [s[:max].abs, s[:min].abs].max
+	above = 0
+	(BUCKETS - 1).downto(0) do |b|
+		above += s[:hist][b]
+		if above * 100 > total
+			return worst if b == BUCKETS - 1
+			return [(1 << b) - 1, worst].min
+		end
+	end
+	return 0
+end
+
+device = TLP.new
+if(device.find)
+	puts "stat    count      min      max     mean      p99"
+	device.stats.each do |s|
+		next puts "%-6s %6d" % [s[:name], 0] if s[:count] == 0
+		puts "%-6s %6d %8d %8d %8.1f %8d" % [s[:name], s[:count], s[:min], s[:max], s[:mean], p99(s)]
+	end
+	device.reset if ARGV[0] == "reset"
+end
+
+device.close